@@ -22,35 +22,149 @@
  * Author: Iuri Snego Cardoso
  * Date: 24 Jun 2024
  */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* mremap() */
+#endif
 #include "lineards.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+
+/* Vetores grandes podem ficar em mapeamentos annimos, que crescem com mremap(). */
+#ifdef __linux__
+#define LDS_HAVE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* Tamanho das pginas grandes transparentes (THP) em x86-64 e arm64 */
+#define LDS_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
 
 #define PRINTREP(file, ch, times) {int i; for(i=0; i<times; i++) putc(ch, file); }
 
-/* Estrutura para lista encadeada */
+/* Estrutura para lista encadeada.
+ * O dado  armazenado logo aps o encadeamento, na mesma alocao do n. */
 typedef struct Node {
-    void *data;
     struct Node *next;
+    unsigned char data[];
 } Node;
 
+/* Nas listas duplamente encadeadas, o ponteiro para o n anterior fica
+ * imediatamente antes do Node, no mesmo bloco. Assim o dado fica na mesma
+ * posio para os dois tipos de lista. Se o dado precisar de alinhamento
+ * maior que o do ponteiro, o bloco tambm tem espao vago antes do Node
+ * (ver node_prefix()). */
+#define NODE_PREV(node) (((Node**)(node))[-1])
+
+/* Bloco de ns alocado de uma nica vez pelo pool. */
+typedef struct PoolChunk {
+    struct PoolChunk *next;
+    size_t free_count; /* Usado apenas durante o trim */
+    _Alignas(max_align_t) unsigned char nodes[];
+} PoolChunk;
+
+/* Pool de ns compartilhado entre listas. */
+typedef struct LDSNodePool {
+    const LDS_ALLOCATOR *allocator;
+    PoolChunk *chunks;
+    Node *free_nodes; /* Lista livre intrusiva, encadeada pelo prprio next dos ns */
+    size_t data_size;
+    size_t node_size;
+    size_t node_offset; /* Espao antes de cada Node, para alinhar o dado */
+    size_t nodes_per_chunk;
+    size_t in_use;
+    size_t high_water;
+    int fixed; /* No obtm blocos alm dos que j tem (modo de tempo real) */
+} LDSNodePool;
+
+/* Bloco de memria da arena. */
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+} ArenaChunk;
+
+/* Arena: alocao por incremento de ponteiro, liberada de uma s vez. */
+typedef struct LDSArena {
+    LDS_ALLOCATOR allocator; /* context aponta para a prpria arena */
+    ArenaChunk *chunks;      /* O primeiro  o bloco corrente */
+    size_t chunk_size;
+    void *last;              /* ltimo bloco entregue, que pode crescer no lugar */
+} LDSArena;
+
+/* Modos de operao da estrutura */
+#define LDS_FLAG_POW2 0x1u /* Capacidade do vetor sempre potncia de 2; ndices por mscara */
+#define LDS_FLAG_INLINE 0x2u /* Elementos do vetor esto no buffer interno da estrutura */
+#define LDS_FLAG_EXTERNAL 0x4u /* A estrutura no foi alocada pela biblioteca (lds_init_*, lote) */
+#define LDS_FLAG_INCREMENTAL 0x8u /* Ao crescer, migra os elementos aos poucos */
+#define LDS_FLAG_MIGRATING 0x10u /* H elementos ainda no vetor antigo */
+#define LDS_FLAG_HUGEPAGES 0x20u /* Vetores mapeados usam pginas grandes */
+#define LDS_FLAG_FIXED 0x40u /* Tempo real: operaes falham em vez de alocar memria */
+#define LDS_FLAG_OWNS_POOL 0x80u /* O pool de ns  privado e  liberado junto com a lista */
+#define LDS_FLAG_VIEW 0x100u /* Viso somente leitura de um trecho de outra estrutura */
+
+/* Mnimo de elementos migrados do vetor antigo a cada operao */
+#define LDS_MIGRATE_STEP 4
+
+/* Crescimento incremental: durante a migrao, as posies lgicas
+ * [start, start + count) ainda esto no vetor antigo; as demais j esto no
+ * novo, na mesma posio fsica que tero no fim. S existe enquanto h uma
+ * migrao em andamento, para no aumentar o cabealho de todas as estruturas. */
+typedef struct VecMigration {
+    void *vector;    /* Vetor antigo */
+    size_t capacity; /* Capacidade do vetor antigo */
+    size_t head;     /* Posio fsica, no vetor antigo, da posio lgica start */
+    size_t start;
+    size_t count;
+    size_t step;     /* Elementos migrados por operao */
+} VecMigration;
+
 /* Estrutura do iterador. */
 typedef struct LDSIterator {
     LINEAR_DS * ds;
     size_t position;
     Node * current;
     Node * previous;
-    lds_return_t (*add)(LDS_ITERATOR *it, void *value);
-    lds_return_t (*next)(LDS_ITERATOR *it);
-    lds_return_t (*get)(LDS_ITERATOR *it, void *element);
-    lds_return_t (*set)(LDS_ITERATOR *it, void *value);
-    lds_return_t (*remove)(LDS_ITERATOR *it, void*removed_element);
-    lds_return_t (*reset)(LDS_ITERATOR *it);
-    lds_return_t (*go)(LDS_ITERATOR *it, size_t position);
 } LDSIterator;
 
-/* Definio da estrutura de dados oculta */
+/* Operaes de um tipo de estrutura. H uma tabela constante por tipo,
+ * compartilhada por todas as instncias. */
+typedef struct LDSOps {
+    lds_return_t (*insert)(LINEAR_DS *ds, size_t position, void *value);
+    lds_return_t (*remove)(LINEAR_DS *ds, size_t position, void *removed_element);
+    lds_return_t (*get)(LINEAR_DS *ds, size_t position, void *element);
+    lds_return_t (*set)(LINEAR_DS *ds, size_t position, void *value);
+    lds_return_t (*set_nocmp)(LINEAR_DS *ds, size_t position, void *value); /* set sem comparar */
+    void * (*ref)(LINEAR_DS *ds, size_t position); /* Endereo do elemento, sem cpia */
+    void * (*emplace)(LINEAR_DS *ds, size_t position); /* Abre espao e devolve o endereo */
+    lds_return_t (*insert_range)(LINEAR_DS *ds, size_t position, const void *src, size_t count);
+    lds_return_t (*get_range)(LINEAR_DS *ds, size_t position, void *dst, size_t count);
+    lds_return_t (*remove_range)(LINEAR_DS *ds, size_t position, size_t count, void *removed);
+    void (*clear)(LINEAR_DS *ds); /* Remove todos os elementos, mantendo a estrutura */
+    void (*free)(LINEAR_DS *ds); /* Libera a memria dos elementos */
+
+    /* Operaes do iterador */
+    lds_return_t (*it_add)(LDS_ITERATOR *it, void *value);
+    lds_return_t (*it_next)(LDS_ITERATOR *it);
+    lds_return_t (*it_prev)(LDS_ITERATOR *it);
+    lds_return_t (*it_get)(LDS_ITERATOR *it, void *element);
+    lds_return_t (*it_set)(LDS_ITERATOR *it, void *value);
+    lds_return_t (*it_remove)(LDS_ITERATOR *it, void*removed_element);
+    lds_return_t (*it_reset)(LDS_ITERATOR *it);
+    lds_return_t (*it_go)(LDS_ITERATOR *it, size_t position);
+    void * (*it_ref)(LDS_ITERATOR *it);
+    size_t (*it_span)(LDS_ITERATOR *it, void **data); /* Trecho contguo a partir do iterador */
+} LDSOps;
+
+/* Definio da estrutura de dados oculta.
+ * Os campos usados em toda operao, de ops a flags, ficam juntos no incio
+ * (72 bytes em plataformas de 64 bits); os demais vm depois. Campos de um s
+ * tipo dividem espao, e o estado que s existe por algum tempo (migrao
+ * incremental) fica numa alocao  parte. O cabealho inteiro precisa caber
+ * em LDS_HANDLE_SIZE (ver lds_init_vector()). */
 typedef struct LinearDS {
+    const LDSOps *ops;
     union {
         struct {
             void *vector;
@@ -65,23 +179,52 @@ typedef struct LinearDS {
     size_t size;
     size_t capacity;
     size_t data_size;
+    size_t stride; /* Distncia, em bytes, entre elementos do vetor (data_size, ou mais com preenchimento) */
     lds_type_t type;
+    unsigned int flags; /* Modos de operao (LDS_FLAG_*) */
+
+    size_t inline_capacity; /* Capacidade do buffer interno (vetor pequeno), ou 0 */
+    const LDS_ALLOCATOR *allocator;
+    LDSNodePool *pool; /* Pool de onde vm os ns da lista, ou NULL */
+
     LDSIterator iterator;
 
+    /* Campos que s um dos tipos usa */
+    union {
+        struct {
+            const LDS_GROWTH_POLICY *growth_policy; /* NULL: capacidade dobra ao encher */
+            VecMigration *migration; /* S com LDS_FLAG_MIGRATING */
+            size_t mmap_threshold; /* Vetores a partir deste tamanho, em bytes, so mapeados; 0 desliga */
+            size_t alignment; /* Alinhamento dos vetores alm do garantido pelo alocador, ou 0 */
+        };
+        LDSIterator seek; /* Lista: cursor interno das operaes por posio, para no mover o iterador */
+    };
+
 #ifndef NDEBUG
     /* Debug */
     FILE * debug_log;
     void (*debug_fmt)(FILE * out, void *value);
 #endif /* NDEBUG */
-
-    /* Ponteiros para funes */
-    lds_return_t (*insert)(LINEAR_DS *ds, size_t position, void *value);
-    lds_return_t (*remove)(LINEAR_DS *ds, size_t position, void *removed_element);
-    lds_return_t (*get)(LINEAR_DS *ds, size_t position, void *element);
-    lds_return_t (*set)(LINEAR_DS *ds, size_t position, void *value);
-    void (*free)(LINEAR_DS *ds); /* Ponteiro para a funo de liberao de memria */
 } LinearDS;
 
+_Static_assert(sizeof(LDSIterator) <= LDS_CURSOR_SIZE, "LDS_CURSOR_SIZE pequeno demais");
+_Static_assert(_Alignof(LDSIterator) <= _Alignof(LDS_CURSOR), "LDS_CURSOR mal alinhado");
+
+/* Funes de alocao de memria */
+static void * mem_alloc(const LDS_ALLOCATOR *allocator, size_t size);
+static void * mem_realloc(const LDS_ALLOCATOR *allocator, void *ptr, size_t old_size, size_t new_size);
+static void mem_free(const LDS_ALLOCATOR *allocator, void *ptr, size_t size);
+static void * map_alloc(size_t size, int huge_pages);
+static void * map_realloc(void *ptr, size_t old_size, size_t new_size, int huge_pages);
+static void map_free(void *ptr, size_t size);
+static void * vec_buf_alloc(LINEAR_DS *ds, size_t size);
+static void * vec_buf_realloc(LINEAR_DS *ds, void *ptr, size_t old_size, size_t new_size);
+static void vec_buf_free(LINEAR_DS *ds, void *ptr, size_t size);
+static void vec_buf_release(LINEAR_DS *ds, void *ptr, size_t size, int mapped);
+static void prefault(void *ptr, size_t size);
+static void * arena_alloc(void *context, size_t size);
+static void * arena_realloc(void *context, void *ptr, size_t old_size, size_t new_size);
+
 /* Funes para manipulao da estrutura de dados */
 static lds_return_t insert_element_in_vector(LINEAR_DS *ds, size_t position, void *value);
 static lds_return_t insert_element_in_list(LINEAR_DS *ds, size_t position, void *value);
@@ -91,14 +234,96 @@ static lds_return_t get_element_from_vector(LINEAR_DS *ds, size_t position, void
 static lds_return_t get_element_from_list(LINEAR_DS *ds, size_t position, void *element);
 static lds_return_t set_element_in_vector(LINEAR_DS *ds, size_t position, void *value);
 static lds_return_t set_element_in_list(LINEAR_DS *ds, size_t position, void *value);
+static lds_return_t set_nocmp_in_vector(LINEAR_DS *ds, size_t position, void *value);
+static lds_return_t set_nocmp_in_list(LINEAR_DS *ds, size_t position, void *value);
+static void * ref_in_vector(LINEAR_DS *ds, size_t position);
+static void * ref_in_list(LINEAR_DS *ds, size_t position);
+static void * emplace_in_vector(LINEAR_DS *ds, size_t position);
+static void * emplace_in_list(LINEAR_DS *ds, size_t position);
+static lds_return_t insert_range_in_vector(LINEAR_DS *ds, size_t position, const void *src, size_t count);
+static lds_return_t insert_range_in_list(LINEAR_DS *ds, size_t position, const void *src, size_t count);
+static lds_return_t get_range_from_vector(LINEAR_DS *ds, size_t position, void *dst, size_t count);
+static lds_return_t get_range_from_list(LINEAR_DS *ds, size_t position, void *dst, size_t count);
+static lds_return_t remove_range_from_vector(LINEAR_DS *ds, size_t position, size_t count, void *removed);
+static lds_return_t remove_range_from_list(LINEAR_DS *ds, size_t position, size_t count, void *removed);
+static void clear_vector(LINEAR_DS *ds);
+static void clear_list(LINEAR_DS *ds);
 static void free_vector(LINEAR_DS *ds);
+static LINEAR_DS* new_vector(size_t initial_capacity, size_t data_size, const LDS_ALLOCATOR *allocator,
+                             size_t inline_capacity);
+static lds_return_t init_vector(LINEAR_DS *ds, size_t initial_capacity, size_t data_size, size_t stride,
+                                size_t alignment, const LDS_ALLOCATOR *allocator, size_t inline_capacity,
+                                const LINEAR_DS *like);
+static size_t vec_header_size(size_t inline_capacity, size_t data_size);
+static size_t vec_inline_offset(void);
+static void * vec_inline_buffer(LINEAR_DS *ds);
+static size_t vec_wrap(LINEAR_DS *ds, size_t index);
+static char * vec_slot(LINEAR_DS *ds, size_t index);
+static char * vec_at(LINEAR_DS *ds, size_t position);
+static lds_return_t vec_resize(LINEAR_DS *ds, size_t new_capacity);
+static lds_return_t vec_start_migration(LINEAR_DS *ds, size_t new_capacity);
+static char * vec_old_at(LINEAR_DS *ds, size_t position);
+static void vec_migrate(LINEAR_DS *ds, size_t count);
+static void vec_finish_migration(LINEAR_DS *ds);
+static void vec_end_migration(LINEAR_DS *ds);
+static char * vec_make_room(LINEAR_DS *ds, size_t position);
+static void vec_close_gap(LINEAR_DS *ds, size_t position);
+static void vec_iterator_inserted(LINEAR_DS *ds, size_t position, size_t count);
+static void vec_iterator_removed(LINEAR_DS *ds, size_t position, size_t count);
+static char * vec_room_while_migrating(LINEAR_DS *ds, size_t position);
+static void vec_close_while_migrating(LINEAR_DS *ds, size_t position);
+static size_t vec_grown_capacity(LINEAR_DS *ds, size_t needed);
+static size_t round_pow2(size_t n);
+static void vec_shrink_by_policy(LINEAR_DS *ds);
+static void vec_move(LINEAR_DS *ds, size_t dst, size_t src, size_t count);
+static void vec_write(LINEAR_DS *ds, size_t position, const char *src, size_t count);
+static lds_return_t vec_open_range(LINEAR_DS *ds, size_t position, size_t count);
+static void vec_read(LINEAR_DS *ds, size_t position, char *dst, size_t count);
 static void free_list(LINEAR_DS *ds);
+static void list_release_nodes(LINEAR_DS *ds);
+static lds_return_t list_new_chain(LINEAR_DS *ds, size_t count, Node **first, Node **last);
+static void list_link_chain(LINEAR_DS *ds, size_t position, Node *first, Node *last, size_t count);
+static Node * list_unlink_chain(LINEAR_DS *ds, size_t position, size_t count, Node **last);
+static int list_nodes_compatible(LINEAR_DS *dst, LINEAR_DS *src);
+static void list_cursors_inserted(LINEAR_DS *ds, LDSIterator *except, size_t position, size_t count,
+                                  Node *first, Node *last);
+static void list_cursors_removed(LINEAR_DS *ds, LDSIterator *except, size_t position, size_t count,
+                                 Node *before, Node *after);
+static LINEAR_DS* new_empty_like(LINEAR_DS *ds, size_t capacity);
+static const LDS_ALLOCATOR * derived_allocator(LINEAR_DS *ds);
+static lds_return_t splice_elements(LINEAR_DS *dst, size_t position, LINEAR_DS *src, size_t from, size_t count);
+static lds_return_t copy_elements(LINEAR_DS *dst, size_t position, LINEAR_DS *src, size_t from, size_t count);
+static void init_list(LINEAR_DS *ds, size_t data_size, const LDS_ALLOCATOR *allocator);
+
+/* Funes para alocao dos ns da lista */
+static Node * new_node(LINEAR_DS *ds);
+static void free_node(LINEAR_DS *ds, Node *node);
+static void list_link_last(LINEAR_DS *ds, Node *node);
+static void list_link_first(LINEAR_DS *ds, Node *node);
+static Node * list_unlink_first(LINEAR_DS *ds);
+static Node * list_unlink_last(LINEAR_DS *ds);
+static Node * list_make_room(LINEAR_DS *ds, size_t position);
+static Node * list_detach(LINEAR_DS *ds, size_t position);
+static Node * it_link_new_node(LDS_ITERATOR *it);
+static Node * it_unlink(LDS_ITERATOR *it);
+static size_t node_data_alignment(size_t data_size);
+static size_t node_prefix_for(int doubly_linked, size_t data_size);
+static size_t node_prefix(LINEAR_DS *ds);
+static Node * pool_get_node(LDSNodePool *pool);
+static lds_return_t pool_add_chunk(LDSNodePool *pool);
+static void pool_put_node(LDSNodePool *pool, Node *node);
+static size_t pool_chunk_bytes(LDSNodePool *pool);
+static Node * pool_sort_nodes(Node *list);
+static PoolChunk * pool_sort_chunks(PoolChunk *list);
 
 /* Funes para manipulao do iterador */
 static lds_return_t it_add_in_vector(LDS_ITERATOR *it, void *value);
 static lds_return_t it_add_in_list(LDS_ITERATOR *it, void *value);
 static lds_return_t it_next_in_vector(LDS_ITERATOR *it);
 static lds_return_t it_next_in_list(LDS_ITERATOR *it);
+static lds_return_t it_prev_in_vector(LDS_ITERATOR *it);
+static lds_return_t it_prev_in_list(LDS_ITERATOR *it);
+static lds_return_t it_prev_in_dlist(LDS_ITERATOR *it);
 static lds_return_t it_get_from_vector(LDS_ITERATOR *it, void *element);
 static lds_return_t it_get_from_list(LDS_ITERATOR *it, void *element);
 static lds_return_t it_remove_from_vector(LDS_ITERATOR *it, void*removed_element);
@@ -107,8 +332,530 @@ static lds_return_t it_reset_in_vector(LDS_ITERATOR *it);
 static lds_return_t it_reset_in_list(LDS_ITERATOR *it);
 static lds_return_t it_go_in_vector(LDS_ITERATOR *it, size_t position);
 static lds_return_t it_go_in_list(LDS_ITERATOR *it, size_t position);
+static lds_return_t it_go_in_dlist(LDS_ITERATOR *it, size_t position);
 static lds_return_t it_set_in_vector(LDS_ITERATOR *it, void *element);
 static lds_return_t it_set_in_list(LDS_ITERATOR *it, void *element);
+static void * it_ref_in_vector(LDS_ITERATOR *it);
+static void * it_ref_in_list(LDS_ITERATOR *it);
+static size_t it_span_in_vector(LDS_ITERATOR *it, void **data);
+static size_t it_span_in_list(LDS_ITERATOR *it, void **data);
+
+/* Vises: as leituras usam as funes do tipo de origem; as alteraes falham. */
+static lds_return_t insert_in_view(LINEAR_DS *ds, size_t position, void *value);
+static lds_return_t remove_from_view(LINEAR_DS *ds, size_t position, void *removed_element);
+static lds_return_t set_in_view(LINEAR_DS *ds, size_t position, void *value);
+static void * emplace_in_view(LINEAR_DS *ds, size_t position);
+static lds_return_t insert_range_in_view(LINEAR_DS *ds, size_t position, const void *src, size_t count);
+static lds_return_t remove_range_from_view(LINEAR_DS *ds, size_t position, size_t count, void *removed);
+static void free_view(LINEAR_DS *ds);
+static lds_return_t it_add_in_view(LDS_ITERATOR *it, void *value);
+static lds_return_t it_set_in_view(LDS_ITERATOR *it, void *value);
+static lds_return_t it_remove_from_view(LDS_ITERATOR *it, void *removed_element);
+
+/* Tabelas de operaes */
+static const LDSOps vector_ops = {
+    insert_element_in_vector, remove_element_from_vector,
+    get_element_from_vector, set_element_in_vector, set_nocmp_in_vector,
+    ref_in_vector, emplace_in_vector,
+    insert_range_in_vector, get_range_from_vector, remove_range_from_vector,
+    clear_vector, free_vector,
+    it_add_in_vector, it_next_in_vector, it_prev_in_vector, it_get_from_vector,
+    it_set_in_vector, it_remove_from_vector, it_reset_in_vector, it_go_in_vector,
+    it_ref_in_vector, it_span_in_vector
+};
+
+static const LDSOps list_ops = {
+    insert_element_in_list, remove_element_from_list,
+    get_element_from_list, set_element_in_list, set_nocmp_in_list,
+    ref_in_list, emplace_in_list,
+    insert_range_in_list, get_range_from_list, remove_range_from_list,
+    clear_list, free_list,
+    it_add_in_list, it_next_in_list, it_prev_in_list, it_get_from_list,
+    it_set_in_list, it_remove_from_list, it_reset_in_list, it_go_in_list,
+    it_ref_in_list, it_span_in_list
+};
+
+static const LDSOps dlist_ops = {
+    insert_element_in_list, remove_element_from_list,
+    get_element_from_list, set_element_in_list, set_nocmp_in_list,
+    ref_in_list, emplace_in_list,
+    insert_range_in_list, get_range_from_list, remove_range_from_list,
+    clear_list, free_list,
+    it_add_in_list, it_next_in_list, it_prev_in_dlist, it_get_from_list,
+    it_set_in_list, it_remove_from_list, it_reset_in_list, it_go_in_dlist,
+    it_ref_in_list, it_span_in_list
+};
+
+static const LDSOps vector_view_ops = {
+    insert_in_view, remove_from_view,
+    get_element_from_vector, set_in_view, set_in_view,
+    ref_in_vector, emplace_in_view,
+    insert_range_in_view, get_range_from_vector, remove_range_from_view,
+    free_view, free_view,
+    it_add_in_view, it_next_in_vector, it_prev_in_vector, it_get_from_vector,
+    it_set_in_view, it_remove_from_view, it_reset_in_vector, it_go_in_vector,
+    it_ref_in_vector, it_span_in_vector
+};
+
+static const LDSOps list_view_ops = {
+    insert_in_view, remove_from_view,
+    get_element_from_list, set_in_view, set_in_view,
+    ref_in_list, emplace_in_view,
+    insert_range_in_view, get_range_from_list, remove_range_from_view,
+    free_view, free_view,
+    it_add_in_view, it_next_in_list, it_prev_in_list, it_get_from_list,
+    it_set_in_view, it_remove_from_view, it_reset_in_list, it_go_in_list,
+    it_ref_in_list, it_span_in_list
+};
+
+static const LDSOps dlist_view_ops = {
+    insert_in_view, remove_from_view,
+    get_element_from_list, set_in_view, set_in_view,
+    ref_in_list, emplace_in_view,
+    insert_range_in_view, get_range_from_list, remove_range_from_view,
+    free_view, free_view,
+    it_add_in_view, it_next_in_list, it_prev_in_dlist, it_get_from_list,
+    it_set_in_view, it_remove_from_view, it_reset_in_list, it_go_in_dlist,
+    it_ref_in_list, it_span_in_list
+};
+
+/* Operaes especializadas por tamanho do elemento. Os corpos recebem o tamanho
+ * como parmetro; chamados com uma constante, o compilador troca memcpy() e
+ * memcmp() por cargas e escritas diretas. A parte estrutural (abrir e fechar
+ * espao, encadear ns)  comum a todos os tamanhos. */
+static inline lds_return_t vec_insert_sized(LINEAR_DS *ds, size_t position, void *value, size_t size) {
+    char *slot = vec_make_room(ds, position);
+    if (slot == NULL) {
+        return LDS_FAIL;
+    }
+    memcpy(slot, value, size);
+    return LDS_SUCCESS;
+}
+
+static inline lds_return_t vec_remove_sized(LINEAR_DS *ds, size_t position, void *removed_element, size_t size) {
+    if (removed_element != NULL) {
+        memcpy(removed_element, vec_at(ds, position), size);
+    }
+    vec_close_gap(ds, position);
+    return LDS_SUCCESS;
+}
+
+static inline lds_return_t vec_get_sized(LINEAR_DS *ds, size_t position, void *element, size_t size) {
+    memcpy(element, vec_at(ds, position), size);
+    return LDS_SUCCESS;
+}
+
+static inline lds_return_t vec_set_sized(LINEAR_DS *ds, size_t position, void *value, size_t size) {
+    char *slot = vec_at(ds, position);
+    if (memcmp(value, slot, size) == 0) {
+        return LDS_FAIL;
+    }
+
+    memcpy(slot, value, size);
+    return LDS_SUCCESS;
+}
+
+static inline lds_return_t list_insert_sized(LINEAR_DS *ds, size_t position, void *value, size_t size) {
+    Node *node = list_make_room(ds, position);
+    if (node == NULL) {
+        return LDS_FAIL;
+    }
+    memcpy(node->data, value, size);
+    return LDS_SUCCESS;
+}
+
+static inline lds_return_t list_remove_sized(LINEAR_DS *ds, size_t position, void *removed_element, size_t size) {
+    Node *node = list_detach(ds, position);
+    if (removed_element != NULL) {
+        memcpy(removed_element, node->data, size);
+    }
+    free_node(ds, node);
+    return LDS_SUCCESS;
+}
+
+static inline lds_return_t it_get_list_sized(LDS_ITERATOR *it, void *element, size_t size) {
+    if (it->position >= it->ds->size) {
+        return LDS_POS_ERR;
+    }
+    memcpy(element, it->current->data, size);
+    return LDS_SUCCESS;
+}
+
+static inline lds_return_t it_set_list_sized(LDS_ITERATOR *it, void *value, size_t size) {
+    if (memcmp(value, it->current->data, size) == 0) {
+        return LDS_FAIL;
+    }
+
+    memcpy(it->current->data, value, size);
+    return LDS_SUCCESS;
+}
+
+static inline lds_return_t list_get_sized(LINEAR_DS *ds, size_t position, void *element, size_t size) {
+    lds_return_t r = ds->ops->it_go(&ds->seek, position);
+    if (r == LDS_SUCCESS) {
+        return it_get_list_sized(&ds->seek, element, size);
+    }
+    return r;
+}
+
+static inline lds_return_t list_set_sized(LINEAR_DS *ds, size_t position, void *value, size_t size) {
+    lds_return_t r = ds->ops->it_go(&ds->seek, position);
+    if (r == LDS_SUCCESS) {
+        return it_set_list_sized(&ds->seek, value, size);
+    }
+    return r;
+}
+
+/* Gera as funes e as tabelas de operaes para elementos de N bytes. */
+#define LDS_SIZED_OPS(N) \
+    static lds_return_t insert_in_vector_##N(LINEAR_DS *ds, size_t position, void *value) { \
+        return vec_insert_sized(ds, position, value, N); \
+    } \
+    static lds_return_t remove_from_vector_##N(LINEAR_DS *ds, size_t position, void *removed_element) { \
+        return vec_remove_sized(ds, position, removed_element, N); \
+    } \
+    static lds_return_t get_from_vector_##N(LINEAR_DS *ds, size_t position, void *element) { \
+        return vec_get_sized(ds, position, element, N); \
+    } \
+    static lds_return_t set_in_vector_##N(LINEAR_DS *ds, size_t position, void *value) { \
+        return vec_set_sized(ds, position, value, N); \
+    } \
+    static lds_return_t set_nocmp_in_vector_##N(LINEAR_DS *ds, size_t position, void *value) { \
+        memcpy(vec_at(ds, position), value, N); \
+        return LDS_SUCCESS; \
+    } \
+    static lds_return_t it_get_from_vector_##N(LDS_ITERATOR *it, void *element) { \
+        return vec_get_sized(it->ds, it->position, element, N); \
+    } \
+    static lds_return_t it_set_in_vector_##N(LDS_ITERATOR *it, void *value) { \
+        return vec_set_sized(it->ds, it->position, value, N); \
+    } \
+    static lds_return_t insert_in_list_##N(LINEAR_DS *ds, size_t position, void *value) { \
+        return list_insert_sized(ds, position, value, N); \
+    } \
+    static lds_return_t remove_from_list_##N(LINEAR_DS *ds, size_t position, void *removed_element) { \
+        return list_remove_sized(ds, position, removed_element, N); \
+    } \
+    static lds_return_t get_from_list_##N(LINEAR_DS *ds, size_t position, void *element) { \
+        return list_get_sized(ds, position, element, N); \
+    } \
+    static lds_return_t set_in_list_##N(LINEAR_DS *ds, size_t position, void *value) { \
+        return list_set_sized(ds, position, value, N); \
+    } \
+    static lds_return_t set_nocmp_in_list_##N(LINEAR_DS *ds, size_t position, void *value) { \
+        memcpy(ref_in_list(ds, position), value, N); \
+        return LDS_SUCCESS; \
+    } \
+    static lds_return_t it_get_from_list_##N(LDS_ITERATOR *it, void *element) { \
+        return it_get_list_sized(it, element, N); \
+    } \
+    static lds_return_t it_set_in_list_##N(LDS_ITERATOR *it, void *value) { \
+        return it_set_list_sized(it, value, N); \
+    } \
+    static const LDSOps vector_ops_##N = { \
+        insert_in_vector_##N, remove_from_vector_##N, \
+        get_from_vector_##N, set_in_vector_##N, set_nocmp_in_vector_##N, \
+        ref_in_vector, emplace_in_vector, \
+        insert_range_in_vector, get_range_from_vector, remove_range_from_vector, \
+        clear_vector, free_vector, \
+        it_add_in_vector, it_next_in_vector, it_prev_in_vector, it_get_from_vector_##N, \
+        it_set_in_vector_##N, it_remove_from_vector, it_reset_in_vector, it_go_in_vector, \
+        it_ref_in_vector, it_span_in_vector \
+    }; \
+    static const LDSOps list_ops_##N = { \
+        insert_in_list_##N, remove_from_list_##N, \
+        get_from_list_##N, set_in_list_##N, set_nocmp_in_list_##N, \
+        ref_in_list, emplace_in_list, \
+        insert_range_in_list, get_range_from_list, remove_range_from_list, \
+        clear_list, free_list, \
+        it_add_in_list, it_next_in_list, it_prev_in_list, it_get_from_list_##N, \
+        it_set_in_list_##N, it_remove_from_list, it_reset_in_list, it_go_in_list, \
+        it_ref_in_list, it_span_in_list \
+    }; \
+    static const LDSOps dlist_ops_##N = { \
+        insert_in_list_##N, remove_from_list_##N, \
+        get_from_list_##N, set_in_list_##N, set_nocmp_in_list_##N, \
+        ref_in_list, emplace_in_list, \
+        insert_range_in_list, get_range_from_list, remove_range_from_list, \
+        clear_list, free_list, \
+        it_add_in_list, it_next_in_list, it_prev_in_dlist, it_get_from_list_##N, \
+        it_set_in_list_##N, it_remove_from_list, it_reset_in_list, it_go_in_dlist, \
+        it_ref_in_list, it_span_in_list \
+    };
+
+LDS_SIZED_OPS(1)
+LDS_SIZED_OPS(2)
+LDS_SIZED_OPS(4)
+LDS_SIZED_OPS(8)
+LDS_SIZED_OPS(16)
+LDS_SIZED_OPS(32)
+
+/* Escolhe a tabela de operaes do tipo, especializada para o tamanho do elemento quando houver. */
+#define LDS_OPS_FOR(N) \
+    case N: \
+        return type == LDS_VECTOR ? &vector_ops_##N : type == LDS_LINKED_LIST ? &list_ops_##N : &dlist_ops_##N;
+
+static const LDSOps * ops_for(lds_type_t type, size_t data_size) {
+    switch (data_size) {
+    LDS_OPS_FOR(1)
+    LDS_OPS_FOR(2)
+    LDS_OPS_FOR(4)
+    LDS_OPS_FOR(8)
+    LDS_OPS_FOR(16)
+    LDS_OPS_FOR(32)
+    default:
+        return type == LDS_VECTOR ? &vector_ops : type == LDS_LINKED_LIST ? &list_ops : &dlist_ops;
+    }
+}
+
+/* Alocador padro, baseado na biblioteca C */
+static void * default_alloc(void *context, size_t size) {
+    (void)context;
+    return malloc(size);
+}
+
+static void * default_realloc(void *context, void *ptr, size_t old_size, size_t new_size) {
+    (void)context;
+    (void)old_size;
+    return realloc(ptr, new_size);
+}
+
+static void default_free(void *context, void *ptr, size_t size) {
+    (void)context;
+    (void)size;
+    free(ptr);
+}
+
+static const LDS_ALLOCATOR default_allocator = {
+    default_alloc, default_realloc, default_free, NULL
+};
+
+static void * mem_alloc(const LDS_ALLOCATOR *allocator, size_t size) {
+    return allocator->alloc(allocator->context, size);
+}
+
+static void * mem_realloc(const LDS_ALLOCATOR *allocator, void *ptr, size_t old_size, size_t new_size) {
+    if (allocator->realloc != NULL) {
+        return allocator->realloc(allocator->context, ptr, old_size, new_size);
+    }
+    void *new_ptr = allocator->alloc(allocator->context, new_size);
+    if (new_ptr != NULL) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        mem_free(allocator, ptr, old_size);
+    }
+    return new_ptr;
+}
+
+static void mem_free(const LDS_ALLOCATOR *allocator, void *ptr, size_t size) {
+    if (allocator->free != NULL) {
+        allocator->free(allocator->context, ptr, size);
+    }
+}
+
+/* Mapeamentos annimos, para vetores grandes. Os tamanhos so arredondados
+ * para pginas inteiras. */
+#ifdef LDS_HAVE_MMAP
+static size_t map_length(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
+static void map_advise(void *ptr, size_t length, int huge_pages) {
+#ifdef MADV_HUGEPAGE
+    if (huge_pages) {
+        madvise(ptr, length, MADV_HUGEPAGE);
+    }
+#else
+    (void)ptr; (void)length; (void)huge_pages;
+#endif
+}
+#endif /* LDS_HAVE_MMAP */
+
+static void * map_alloc(size_t size, int huge_pages) {
+#ifdef LDS_HAVE_MMAP
+    size_t length = map_length(size);
+    size_t extra = huge_pages ? LDS_HUGE_PAGE_SIZE : 0;
+    char *ptr = (char*)mmap(NULL, length + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+    if (extra > 0) {
+        /* Alinha o incio a uma pgina grande e devolve as sobras. */
+        size_t lead = (LDS_HUGE_PAGE_SIZE - (uintptr_t)ptr % LDS_HUGE_PAGE_SIZE) % LDS_HUGE_PAGE_SIZE;
+        if (lead > 0) {
+            munmap(ptr, lead);
+        }
+        if (extra > lead) {
+            munmap(ptr + lead + length, extra - lead);
+        }
+        ptr += lead;
+    }
+    map_advise(ptr, length, huge_pages);
+    return ptr;
+#else
+    (void)size; (void)huge_pages;
+    return NULL;
+#endif
+}
+
+/* Redimensiona o mapeamento movendo as tabelas de pginas, sem copiar os dados. */
+static void * map_realloc(void *ptr, size_t old_size, size_t new_size, int huge_pages) {
+#ifdef LDS_HAVE_MMAP
+    size_t old_length = map_length(old_size);
+    size_t length = map_length(new_size);
+    void *new_ptr = MAP_FAILED;
+#ifdef MREMAP_FIXED
+    if (huge_pages) {
+        /* mremap() poderia mover o mapeamento para um endereo fora do alinhamento
+         * de pgina grande. Cresce no lugar se der; seno, move para uma regio j
+         * alinhada, reservada como em map_alloc(), que o mapeamento substitui. */
+        new_ptr = mremap(ptr, old_length, length, 0);
+        if (new_ptr == MAP_FAILED) {
+            void *target = map_alloc(new_size, 1);
+            if (target == NULL) {
+                return NULL;
+            }
+            new_ptr = mremap(ptr, old_length, length, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+            if (new_ptr == MAP_FAILED) {
+                munmap(target, length);
+                return NULL;
+            }
+        }
+    }
+#endif
+    if (new_ptr == MAP_FAILED) {
+        new_ptr = mremap(ptr, old_length, length, MREMAP_MAYMOVE);
+        if (new_ptr == MAP_FAILED) {
+            return NULL;
+        }
+    }
+    map_advise(new_ptr, length, huge_pages);
+    return new_ptr;
+#else
+    (void)ptr; (void)old_size; (void)new_size; (void)huge_pages;
+    return NULL;
+#endif
+}
+
+static void map_free(void *ptr, size_t size) {
+#ifdef LDS_HAVE_MMAP
+    munmap(ptr, map_length(size));
+#else
+    (void)ptr; (void)size;
+#endif
+}
+
+/* Blocos com alinhamento maior que o do alocador: obtm alignment bytes a mais
+ * e guarda o endereo original logo antes do endereo alinhado. */
+static void * aligned_alloc_from(const LDS_ALLOCATOR *allocator, size_t size, size_t alignment) {
+    char *block = (char*)mem_alloc(allocator, size + alignment);
+    if (block == NULL) {
+        return NULL;
+    }
+    char *ptr = block + alignment - (uintptr_t)block % alignment;
+    ((void**)ptr)[-1] = block;
+    return ptr;
+}
+
+static void aligned_free_to(const LDS_ALLOCATOR *allocator, void *ptr, size_t size, size_t alignment) {
+    mem_free(allocator, ((void**)ptr)[-1], size + alignment);
+}
+
+/* Memria dos elementos do vetor: mapeada a partir do limite configurado,
+ * obtida do alocador abaixo dele. Quem  mapeado depende s do tamanho.
+ * Mapeamentos comeam em pgina, o que cobre alinhamentos de at 4 KiB. */
+static int vec_buf_is_mapped(LINEAR_DS *ds, size_t size) {
+    return ds->mmap_threshold > 0 && size >= ds->mmap_threshold && ds->alignment <= 4096;
+}
+
+static void * vec_buf_alloc(LINEAR_DS *ds, size_t size) {
+    if (vec_buf_is_mapped(ds, size)) {
+        return map_alloc(size, (ds->flags & LDS_FLAG_HUGEPAGES) != 0);
+    }
+    if (ds->alignment > 0) {
+        return aligned_alloc_from(ds->allocator, size, ds->alignment);
+    }
+    return mem_alloc(ds->allocator, size);
+}
+
+static void * vec_buf_realloc(LINEAR_DS *ds, void *ptr, size_t old_size, size_t new_size) {
+    int old_mapped = vec_buf_is_mapped(ds, old_size);
+    if (old_mapped == vec_buf_is_mapped(ds, new_size)) {
+        if (old_mapped) {
+            return map_realloc(ptr, old_size, new_size, (ds->flags & LDS_FLAG_HUGEPAGES) != 0);
+        }
+        if (ds->alignment == 0) {
+            return mem_realloc(ds->allocator, ptr, old_size, new_size);
+        }
+        /* realloc() no preserva o alinhamento: segue para alocar e copiar. */
+    }
+
+    /* Passou pelo limite, ou  alinhado: aloca, copia e libera. */
+    void *new_ptr = vec_buf_alloc(ds, new_size);
+    if (new_ptr == NULL) {
+        return NULL;
+    }
+    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    vec_buf_free(ds, ptr, old_size);
+    return new_ptr;
+}
+
+static void vec_buf_free(LINEAR_DS *ds, void *ptr, size_t size) {
+    vec_buf_release(ds, ptr, size, vec_buf_is_mapped(ds, size));
+}
+
+static void vec_buf_release(LINEAR_DS *ds, void *ptr, size_t size, int mapped) {
+    if (mapped) {
+        map_free(ptr, size);
+    }
+    else if (ds->alignment > 0) {
+        aligned_free_to(ds->allocator, ptr, size, ds->alignment);
+    }
+    else {
+        mem_free(ds->allocator, ptr, size);
+    }
+}
+
+/* Alocador do modo de tempo real com memria travada: cada bloco  um
+ * mapeamento prprio, travado na memria fsica por mlock(). */
+static void * locked_alloc(void *context, size_t size) {
+    (void)context;
+    void *ptr = map_alloc(size, 0);
+#ifdef LDS_HAVE_MMAP
+    if (ptr != NULL && mlock(ptr, size) != 0) {
+        map_free(ptr, size);
+        return NULL;
+    }
+#endif
+    return ptr;
+}
+
+static void locked_free(void *context, void *ptr, size_t size) {
+    (void)context;
+#ifdef LDS_HAVE_MMAP
+    munlock(ptr, size);
+#endif
+    map_free(ptr, size);
+}
+
+static const LDS_ALLOCATOR locked_allocator = {
+    locked_alloc,
+    NULL,
+    locked_free,
+    NULL
+};
+
+/* Toca cada pgina do bloco, para que os acessos futuros no causem falta de pgina. */
+static void prefault(void *ptr, size_t size) {
+    volatile char *bytes = (volatile char*)ptr;
+    size_t i;
+    for (i = 0; i < size; i += 4096) {
+        bytes[i] = bytes[i];
+    }
+    if (size > 0) {
+        bytes[size - 1] = bytes[size - 1];
+    }
+}
 
 #ifdef NDEBUG
 #define print_debug(ds, action);
@@ -130,7 +877,8 @@ static void print_debug(LINEAR_DS * ds, char action[]) {
                    ds->size, ds->capacity, ds->storage.head, ds->storage.tail);
         }
         else {
-            fprintf(ds->debug_log, "type: LDS_LINKED_LIST; size: %llu\n",
+            fprintf(ds->debug_log, "type: %s; size: %llu\n",
+                   ds->type == LDS_DOUBLY_LINKED_LIST ? "LDS_DOUBLY_LINKED_LIST" : "LDS_LINKED_LIST",
                    ds->size);
         }
         PRINTREP(ds->debug_log, '-', 80);
@@ -139,7 +887,7 @@ static void print_debug(LINEAR_DS * ds, char action[]) {
         if (ds->type == LDS_VECTOR) {
             size_t i;
             for(i=0; i<ds->size; i++) {
-                void * v = (char *)ds->storage.vector + ((ds->storage.head + i) % ds->capacity) * ds->data_size;
+                void * v = vec_at(ds, i);
                 ds->debug_fmt(ds->debug_log,v);
             }
         }
@@ -161,305 +909,2145 @@ static void print_debug(LINEAR_DS * ds, char action[]) {
 
 /* Implementao das funes de manipulao */
 LINEAR_DS* lds_new_vector(size_t initial_capacity, size_t data_size) {
-    LINEAR_DS *ds = (LINEAR_DS*)malloc(sizeof(LINEAR_DS));
+    return lds_new_vector_ex(initial_capacity, data_size, NULL);
+}
+
+LINEAR_DS* lds_new_vector_ex(size_t initial_capacity, size_t data_size, const LDS_ALLOCATOR *allocator) {
+    return new_vector(initial_capacity, data_size, allocator, 0);
+}
+
+LINEAR_DS* lds_new_small_vector(size_t inline_capacity, size_t data_size) {
+    return new_vector(inline_capacity, data_size, NULL, inline_capacity);
+}
+
+LINEAR_DS* lds_new_small_vector_ex(size_t inline_capacity, size_t data_size, const LDS_ALLOCATOR *allocator) {
+    return new_vector(inline_capacity, data_size, allocator, inline_capacity);
+}
+
+LINEAR_DS* lds_new_vector_aligned(size_t initial_capacity, size_t data_size, size_t alignment, int pad) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        return NULL; /* O alinhamento precisa ser potncia de 2 */
+    }
+    size_t stride = pad ? (data_size + alignment - 1) / alignment * alignment : data_size;
+    LINEAR_DS *ds = (LINEAR_DS*)mem_alloc(&default_allocator, sizeof(LINEAR_DS));
+    if (ds == NULL) {
+        return NULL; /* Falha ao alocar memria */
+    }
+    /* O alocador j garante o alinhamento de max_align_t. */
+    if (init_vector(ds, initial_capacity, data_size, stride, alignment > _Alignof(max_align_t) ? alignment : 0,
+                    &default_allocator, 0, NULL) != LDS_SUCCESS) {
+        mem_free(&default_allocator, ds, sizeof(LINEAR_DS));
+        return NULL; /* Falha ao alocar memria */
+    }
+    print_debug(ds, "lds_new_vector_aligned");
+    return ds;
+}
+
+/* Cria um vetor. Com inline_capacity > 0, os primeiros elementos ficam num buffer
+ * interno, alocado junto com a prpria estrutura. */
+static LINEAR_DS* new_vector(size_t initial_capacity, size_t data_size, const LDS_ALLOCATOR *allocator,
+                             size_t inline_capacity) {
+    if (allocator == NULL) {
+        allocator = &default_allocator;
+    }
+    size_t header_size = vec_header_size(inline_capacity, data_size);
+    LINEAR_DS *ds = (LINEAR_DS*)mem_alloc(allocator, header_size);
     if (ds == NULL) {
         return NULL; /* Falha ao alocar memria */
     }
-    ds->storage.vector = malloc(initial_capacity * data_size);
-    if (ds->storage.vector == NULL) {
-        free(ds);
+    if (init_vector(ds, initial_capacity, data_size, data_size, 0, allocator, inline_capacity, NULL) != LDS_SUCCESS) {
+        mem_free(allocator, ds, header_size);
         return NULL; /* Falha ao alocar memria */
     }
+    print_debug(ds, "lds_new_vector");
+    return ds;
+}
+
+/* Inicializa os campos de um vetor cujo cabealho j existe. Se like no for
+ * NULL, o vetor herda dele as opes de crescimento e de memria; elas valem
+ * j para a alocao do buffer (um vetor acima do limite de mmap nasce mapeado). */
+static lds_return_t init_vector(LINEAR_DS *ds, size_t initial_capacity, size_t data_size, size_t stride,
+                                size_t alignment, const LDS_ALLOCATOR *allocator, size_t inline_capacity,
+                                const LINEAR_DS *like) {
+    ds->flags = 0;
+    ds->inline_capacity = inline_capacity;
+    ds->allocator = allocator;
+    ds->stride = stride;
+    ds->alignment = alignment;
+    ds->mmap_threshold = 0;
+    ds->growth_policy = NULL;
+    if (like != NULL) {
+        ds->flags = like->flags & (LDS_FLAG_POW2 | LDS_FLAG_INCREMENTAL | LDS_FLAG_HUGEPAGES);
+        ds->mmap_threshold = like->mmap_threshold;
+        ds->growth_policy = like->growth_policy;
+    }
+    if (inline_capacity > 0) {
+        ds->storage.vector = vec_inline_buffer(ds);
+        ds->flags |= LDS_FLAG_INLINE;
+    }
+    else {
+        ds->storage.vector = vec_buf_alloc(ds, initial_capacity * stride);
+        if (ds->storage.vector == NULL) {
+            return LDS_FAIL; /* Falha ao alocar memria */
+        }
+    }
     ds->size = 0;
     ds->capacity = initial_capacity;
     ds->data_size = data_size;
     ds->type = LDS_VECTOR;
     ds->storage.head = 0;
     ds->storage.tail = 0;
+    ds->pool = NULL;
+    ds->migration = NULL;
 #ifndef NDEBUG
     ds->debug_log = NULL;
 #endif
 
-    /* Inicializa os ponteiros para as funes */
-    ds->insert = insert_element_in_vector;
-    ds->remove = remove_element_from_vector;
-    ds->get = get_element_from_vector;
-    ds->set = set_element_in_vector;
-    ds->free = free_vector;
+    /* Inicializa a tabela de operaes */
+    ds->ops = ops_for(LDS_VECTOR, data_size);
 
     /* Inicializa o iterador */
     ds->iterator.ds = ds;
     ds->iterator.position = 0;
     ds->iterator.current = NULL;
     ds->iterator.previous = NULL;
-    ds->iterator.add = it_add_in_vector;
-    ds->iterator.next = it_next_in_vector;
-    ds->iterator.get = it_get_from_vector;
-    ds->iterator.set = it_set_in_vector;
-    ds->iterator.remove = it_remove_from_vector;
-    ds->iterator.reset = it_reset_in_vector;
-    ds->iterator.go = it_go_in_vector;
-
-    print_debug(ds, "lds_new_vector");
-    return ds;
+    return LDS_SUCCESS;
 }
 
 LINEAR_DS* lds_new_list(size_t data_size) {
-    LINEAR_DS *ds = (LINEAR_DS*)malloc(sizeof(LINEAR_DS));
+    return lds_new_list_ex(data_size, NULL);
+}
+
+LINEAR_DS* lds_new_list_ex(size_t data_size, const LDS_ALLOCATOR *allocator) {
+    if (allocator == NULL) {
+        allocator = &default_allocator;
+    }
+    LINEAR_DS *ds = (LINEAR_DS*)mem_alloc(allocator, sizeof(LINEAR_DS));
     if (ds == NULL) {
         return NULL; /* Falha ao alocar memria */
     }
+    init_list(ds, data_size, allocator);
+    print_debug(ds, "lds_new_list");
+    return ds;
+}
+
+/* Inicializa os campos de uma lista cujo cabealho j existe. */
+static void init_list(LINEAR_DS *ds, size_t data_size, const LDS_ALLOCATOR *allocator) {
+    ds->inline_capacity = 0;
+    ds->allocator = allocator;
     ds->storage.list.first = NULL;
     ds->storage.list.last = NULL;
     ds->size = 0;
     ds->data_size = data_size;
     ds->type = LDS_LINKED_LIST;
+    ds->flags = 0;
+    ds->pool = NULL;
 #ifndef NDEBUG
     ds->debug_log = NULL;
 #endif
-    /* Inicializa os ponteiros para as funes */
-    ds->insert = insert_element_in_list;
-    ds->remove = remove_element_from_list;
-    ds->get = get_element_from_list;
-    ds->set = set_element_in_list;
-    ds->free = free_list;
+    /* Inicializa a tabela de operaes */
+    ds->ops = ops_for(LDS_LINKED_LIST, data_size);
 
     /* Inicializa o iterador */
     ds->iterator.ds = ds;
     ds->iterator.position = 0;
     ds->iterator.current = NULL;
     ds->iterator.previous = NULL;
-    ds->iterator.add = it_add_in_list;
-    ds->iterator.next = it_next_in_list;
-    ds->iterator.get = it_get_from_list;
-    ds->iterator.set = it_set_in_list;
-    ds->iterator.remove = it_remove_from_list;
-    ds->iterator.reset = it_reset_in_list;
-    ds->iterator.go = it_go_in_list;
+    ds->seek = ds->iterator;
+}
 
-    print_debug(ds, "lds_new_list");
+LINEAR_DS* lds_new_dlist(size_t data_size) {
+    return lds_new_dlist_ex(data_size, NULL);
+}
+
+LINEAR_DS* lds_new_dlist_ex(size_t data_size, const LDS_ALLOCATOR *allocator) {
+    LINEAR_DS *ds = lds_new_list_ex(data_size, allocator);
+    if (ds == NULL) {
+        return NULL; /* Falha ao alocar memria */
+    }
+    ds->type = LDS_DOUBLY_LINKED_LIST;
+    ds->ops = ops_for(LDS_DOUBLY_LINKED_LIST, data_size);
+
+    print_debug(ds, "lds_new_dlist");
+    return ds;
+}
+
+LINEAR_DS* lds_new_rt_vector(size_t capacity, size_t data_size, int lock_memory) {
+    /* Os elementos ficam no buffer interno: estrutura e elementos num s bloco. */
+    LINEAR_DS *ds = new_vector(capacity, data_size, lock_memory ? &locked_allocator : NULL, capacity);
+    if (ds == NULL) {
+        return NULL; /* Falha ao alocar memria */
+    }
+    prefault(ds, vec_header_size(ds->inline_capacity, data_size));
+    ds->flags |= LDS_FLAG_FIXED;
+    print_debug(ds, "lds_new_rt_vector");
+    return ds;
+}
+
+LINEAR_DS* lds_new_rt_list(size_t data_size, size_t max_nodes, int lock_memory) {
+    const LDS_ALLOCATOR *allocator = lock_memory ? &locked_allocator : &default_allocator;
+    LDSNodePool *pool = lds_new_node_pool_ex(data_size, max_nodes, allocator);
+    if (pool == NULL) {
+        return NULL; /* Falha ao alocar memria */
+    }
+    /* Todos os ns vm de um nico bloco, obtido agora. */
+    LINEAR_DS *ds = lds_new_list_ex(data_size, allocator);
+    if (ds == NULL || pool_add_chunk(pool) != LDS_SUCCESS) {
+        lds_free(ds);
+        lds_free_node_pool(pool);
+        return NULL; /* Falha ao alocar memria */
+    }
+    pool->fixed = 1;
+    prefault(pool->chunks, sizeof(PoolChunk) + pool_chunk_bytes(pool));
+    ds->pool = pool;
+    ds->flags |= LDS_FLAG_FIXED | LDS_FLAG_OWNS_POOL;
+    print_debug(ds, "lds_new_rt_list");
+    return ds;
+}
+
+lds_return_t lds_allocation_free(LINEAR_DS *ds) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    /* As vises tambm tm LDS_FLAG_FIXED, s para recusar alteraes. */
+    if (ds->flags & LDS_FLAG_VIEW) {
+        return LDS_FAIL;
+    }
+    return (ds->flags & LDS_FLAG_FIXED) ? LDS_SUCCESS : LDS_FAIL;
+}
+
+/* Cabealhos na memria do chamador: LDS_HANDLE_STORAGE precisa comportar a
+ * estrutura. Se o cabealho crescer alm disso, a compilao falha aqui. */
+_Static_assert(sizeof(LinearDS) <= LDS_HANDLE_SIZE, "LDS_HANDLE_SIZE pequeno demais para LinearDS");
+_Static_assert(_Alignof(LinearDS) <= _Alignof(LDS_HANDLE_STORAGE), "LDS_HANDLE_STORAGE mal alinhado");
+
+LINEAR_DS* lds_init_vector(LDS_HANDLE_STORAGE *storage, size_t initial_capacity, size_t data_size,
+                           const LDS_ALLOCATOR *allocator) {
+    if (storage == NULL) {
+        return NULL;
+    }
+    if (allocator == NULL) {
+        allocator = &default_allocator;
+    }
+    LINEAR_DS *ds = (LINEAR_DS*)storage;
+    if (init_vector(ds, initial_capacity, data_size, data_size, 0, allocator, 0, NULL) != LDS_SUCCESS) {
+        return NULL; /* Falha ao alocar memria */
+    }
+    ds->flags |= LDS_FLAG_EXTERNAL;
+    print_debug(ds, "lds_init_vector");
+    return ds;
+}
+
+LINEAR_DS* lds_init_list(LDS_HANDLE_STORAGE *storage, size_t data_size, const LDS_ALLOCATOR *allocator) {
+    if (storage == NULL) {
+        return NULL;
+    }
+    if (allocator == NULL) {
+        allocator = &default_allocator;
+    }
+    LINEAR_DS *ds = (LINEAR_DS*)storage;
+    init_list(ds, data_size, allocator);
+    ds->flags |= LDS_FLAG_EXTERNAL;
+    print_debug(ds, "lds_init_list");
     return ds;
 }
 
-lds_return_t lds_insert(LINEAR_DS *ds, size_t position, void *value) {
-    if (ds == NULL || value == NULL) {
-        return LDS_NULL;
+void lds_destroy(LINEAR_DS *ds) {
+    print_debug(ds, "lds_destroy");
+    if (ds != NULL) {
+        ds->ops->free(ds);
+    }
+}
+
+lds_return_t lds_new_vector_batch(LINEAR_DS *out[], size_t count, size_t initial_capacity, size_t data_size) {
+    if (out == NULL) {
+        return LDS_NULL;
+    }
+    if (count == 0) {
+        return LDS_SUCCESS;
+    }
+    LINEAR_DS *block = (LINEAR_DS*)mem_alloc(&default_allocator, count * sizeof(LINEAR_DS));
+    if (block == NULL) {
+        return LDS_FAIL; /* Falha ao alocar memria */
+    }
+    size_t i;
+    for (i = 0; i < count; i++) {
+        if (init_vector(&block[i], initial_capacity, data_size, data_size, 0, &default_allocator, 0, NULL) != LDS_SUCCESS) {
+            /* Desfaz os vetores j criados */
+            while (i > 0) {
+                i--;
+                free_vector(&block[i]);
+            }
+            mem_free(&default_allocator, block, count * sizeof(LINEAR_DS));
+            return LDS_FAIL;
+        }
+        block[i].flags |= LDS_FLAG_EXTERNAL;
+        out[i] = &block[i];
+    }
+    return LDS_SUCCESS;
+}
+
+lds_return_t lds_new_list_batch(LINEAR_DS *out[], size_t count, size_t data_size) {
+    if (out == NULL) {
+        return LDS_NULL;
+    }
+    if (count == 0) {
+        return LDS_SUCCESS;
+    }
+    LINEAR_DS *block = (LINEAR_DS*)mem_alloc(&default_allocator, count * sizeof(LINEAR_DS));
+    if (block == NULL) {
+        return LDS_FAIL; /* Falha ao alocar memria */
+    }
+    size_t i;
+    for (i = 0; i < count; i++) {
+        init_list(&block[i], data_size, &default_allocator);
+        block[i].flags |= LDS_FLAG_EXTERNAL;
+        out[i] = &block[i];
+    }
+    return LDS_SUCCESS;
+}
+
+void lds_free_batch(LINEAR_DS *ds[], size_t count) {
+    if (ds == NULL || count == 0) {
+        return;
+    }
+    size_t i;
+    for (i = 0; i < count; i++) {
+        ds[i]->ops->free(ds[i]);
+    }
+    /* Os cabealhos esto num nico bloco, que comea no primeiro. */
+    mem_free(&default_allocator, ds[0], count * sizeof(LINEAR_DS));
+}
+
+lds_return_t lds_insert(LINEAR_DS *ds, size_t position, void *value) {
+    if (ds == NULL || value == NULL) {
+        return LDS_NULL;
+    }
+    if (position > ds->size || position < 0) {
+        return LDS_POS_ERR;
+    }
+    lds_return_t r = ds->ops->insert(ds, position, value);
+    print_debug(ds, "lds_insert");
+    return r;
+}
+
+
+void * lds_emplace(LINEAR_DS *ds, size_t position) {
+    if (ds == NULL || position > ds->size) {
+        return NULL;
+    }
+    /* Sem print_debug: o elemento novo ainda no tem valor. */
+    return ds->ops->emplace(ds, position);
+}
+
+lds_return_t lds_insert_last(LINEAR_DS *ds, void *value) {
+    return lds_insert(ds, ds->size, value);
+}
+
+lds_return_t lds_insert_range(LINEAR_DS *ds, size_t position, const void *src, size_t count) {
+    if (ds == NULL || src == NULL) {
+        return LDS_NULL;
+    }
+    if (position > ds->size) {
+        return LDS_POS_ERR;
+    }
+    if (count == 0) {
+        return LDS_SUCCESS;
+    }
+    lds_return_t r = ds->ops->insert_range(ds, position, src, count);
+    print_debug(ds, "lds_insert_range");
+    return r;
+}
+
+lds_return_t lds_get_range(LINEAR_DS *ds, size_t position, void *dst, size_t count) {
+    if (ds == NULL || dst == NULL) {
+        return LDS_NULL;
+    }
+    if (position > ds->size || count > ds->size - position) {
+        return LDS_POS_ERR;
+    }
+    if (count == 0) {
+        return LDS_SUCCESS;
+    }
+    lds_return_t r = ds->ops->get_range(ds, position, dst, count);
+    print_debug(ds, "lds_get_range");
+    return r;
+}
+
+lds_return_t lds_get(LINEAR_DS *ds, size_t position, void *element) {
+    if (ds == NULL || element == NULL) {
+        return LDS_NULL;
+    }
+    if (position >= ds->size || position < 0) {
+        return LDS_POS_ERR;
+    }
+    lds_return_t r = ds->ops->get(ds, position, element);
+    print_debug(ds, "lds_get");
+    return r;
+}
+
+lds_return_t lds_set_nocmp(LINEAR_DS *ds, size_t position, void *value) {
+    if (ds == NULL || value == NULL) {
+        return LDS_NULL;
+    }
+    if (position >= ds->size) {
+        return LDS_POS_ERR;
+    }
+    lds_return_t r = ds->ops->set_nocmp(ds, position, value);
+    print_debug(ds, "lds_set_nocmp");
+    return r;
+}
+
+void * lds_get_ref(LINEAR_DS *ds, size_t position) {
+    if (ds == NULL || position >= ds->size) {
+        return NULL;
+    }
+    return ds->ops->ref(ds, position);
+}
+
+void * lds_front_ref(LINEAR_DS *ds) {
+    return lds_get_ref(ds, 0);
+}
+
+lds_return_t lds_set(LINEAR_DS *ds, size_t position, void *value) {
+    if (ds == NULL || value == NULL) {
+        return LDS_NULL;
+    }
+    if (position >= ds->size || position < 0) {
+        return LDS_POS_ERR;
+    }
+    lds_return_t r = ds->ops->set(ds, position, value);
+    print_debug(ds, "lds_set");
+    return r;
+}
+
+lds_return_t lds_remove(LINEAR_DS *ds, size_t position, void *removed_element) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (position >= ds->size || position < 0) {
+        return LDS_POS_ERR;
+    }
+    lds_return_t r = ds->ops->remove(ds, position, removed_element);
+    print_debug(ds, "lds_remove");
+    return r;
+}
+
+lds_return_t lds_remove_range(LINEAR_DS *ds, size_t position, size_t count, void *removed) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (position > ds->size || count > ds->size - position) {
+        return LDS_POS_ERR;
+    }
+    if (count == 0) {
+        return LDS_SUCCESS;
+    }
+    lds_return_t r = ds->ops->remove_range(ds, position, count, removed);
+    print_debug(ds, "lds_remove_range");
+    return r;
+}
+
+lds_return_t lds_clear(LINEAR_DS *ds) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (ds->flags & LDS_FLAG_VIEW) {
+        return LDS_FAIL;
+    }
+    ds->ops->clear(ds);
+    print_debug(ds, "lds_clear");
+    return LDS_SUCCESS;
+}
+
+lds_return_t lds_splice(LINEAR_DS *dst, size_t position, LINEAR_DS *src, size_t from, size_t count) {
+    if (dst == NULL || src == NULL) {
+        return LDS_NULL;
+    }
+    if (position > dst->size || from > src->size || count > src->size - from) {
+        return LDS_POS_ERR;
+    }
+    if (dst == src || dst->data_size != src->data_size || ((dst->flags | src->flags) & LDS_FLAG_VIEW)) {
+        return LDS_FAIL;
+    }
+    if (count == 0) {
+        return LDS_SUCCESS;
+    }
+    lds_return_t r = splice_elements(dst, position, src, from, count);
+    print_debug(dst, "lds_splice");
+    return r;
+}
+
+lds_return_t lds_concat(LINEAR_DS *dst, LINEAR_DS *src) {
+    if (dst == NULL || src == NULL) {
+        return LDS_NULL;
+    }
+    return lds_splice(dst, dst->size, src, 0, src->size);
+}
+
+LINEAR_DS* lds_split(LINEAR_DS *ds, size_t position) {
+    /* Tempo real: a nova estrutura exigiria alocar memria. */
+    if (ds == NULL || position > ds->size || (ds->flags & LDS_FLAG_FIXED)) {
+        return NULL;
+    }
+    size_t count = ds->size - position;
+    LINEAR_DS *tail = new_empty_like(ds, count > 0 ? count : 1);
+    if (tail == NULL) {
+        return NULL; /* Falha ao alocar memria */
+    }
+    if (count > 0 && splice_elements(tail, 0, ds, position, count) != LDS_SUCCESS) {
+        lds_free(tail);
+        return NULL; /* Falha ao alocar memria */
+    }
+    print_debug(ds, "lds_split");
+    return tail;
+}
+
+LINEAR_DS* lds_view(LINEAR_DS *ds, size_t position, size_t count) {
+    if (ds == NULL || position > ds->size || count > ds->size - position) {
+        return NULL;
+    }
+    const LDS_ALLOCATOR *allocator = derived_allocator(ds);
+    LINEAR_DS *view = (LINEAR_DS*)mem_alloc(allocator, sizeof(LINEAR_DS));
+    if (view == NULL) {
+        return NULL; /* Falha ao alocar memria */
+    }
+
+    /* A viso  um cabealho do mesmo tipo que aponta para a memria de ds:
+     * as leituras funcionam sem saber que se trata de uma viso. */
+    *view = *ds;
+    view->allocator = allocator;
+    view->size = count;
+    view->inline_capacity = 0;
+    view->flags = (ds->flags & (LDS_FLAG_POW2 | LDS_FLAG_MIGRATING | LDS_FLAG_HUGEPAGES | LDS_FLAG_INCREMENTAL)) |
+                  LDS_FLAG_FIXED | LDS_FLAG_VIEW;
+    if (ds->flags & LDS_FLAG_OWNS_POOL) {
+        view->pool = NULL; /* O pool  de ds; uma cpia da viso no pode us-lo */
+    }
+#ifndef NDEBUG
+    view->debug_log = NULL;
+#endif
+    if (ds->type == LDS_VECTOR) {
+        view->ops = &vector_view_ops;
+        view->storage.head = vec_wrap(ds, ds->storage.head + position);
+        view->storage.tail = vec_wrap(ds, view->storage.head + count);
+        if (ds->flags & LDS_FLAG_MIGRATING) {
+            /* A viso tem sua prpria cpia do estado da migrao, com start relativo a ela;
+             * em aritmtica modular, position - start continua certo em vec_at. */
+            view->migration = (VecMigration*)mem_alloc(allocator, sizeof(VecMigration));
+            if (view->migration == NULL) {
+                mem_free(allocator, view, sizeof(LINEAR_DS));
+                return NULL; /* Falha ao alocar memria */
+            }
+            *view->migration = *ds->migration;
+            view->migration->start -= position;
+        }
+    }
+    else {
+        view->ops = ds->type == LDS_DOUBLY_LINKED_LIST ? &dlist_view_ops : &list_view_ops;
+        view->storage.list.first = NULL;
+        view->storage.list.last = NULL;
+        if (count > 0) {
+            ds->ops->it_go(&ds->seek, position);
+            view->storage.list.first = ds->seek.current;
+            ds->ops->it_go(&ds->seek, position + count - 1);
+            view->storage.list.last = ds->seek.current;
+        }
+    }
+    view->iterator.ds = view;
+    view->iterator.position = 0;
+    view->iterator.current = NULL;
+    view->iterator.previous = NULL;
+    if (ds->type != LDS_VECTOR) {
+        view->iterator.current = view->storage.list.first;
+        view->seek = view->iterator;
+    }
+    print_debug(view, "lds_view");
+    return view;
+}
+
+LINEAR_DS* lds_view_materialize(LINEAR_DS *view) {
+    if (view == NULL) {
+        return NULL;
+    }
+    LINEAR_DS *copy = new_empty_like(view, view->size > 0 ? view->size : 1);
+    if (copy == NULL) {
+        return NULL; /* Falha ao alocar memria */
+    }
+    if (view->size > 0 && copy_elements(copy, 0, view, 0, view->size) != LDS_SUCCESS) {
+        lds_free(copy);
+        return NULL; /* Falha ao alocar memria */
+    }
+    print_debug(copy, "lds_view_materialize");
+    return copy;
+}
+
+/* Move count elementos (count > 0) de src, a partir de from, para a posio
+ * position de dst. Listas compatveis s trocam o encadeamento dos ns; nos
+ * demais casos, os elementos so copiados para dst antes de sarem de src, de
+ * modo que uma falha de memria deixa as duas estruturas como estavam. */
+static lds_return_t splice_elements(LINEAR_DS *dst, size_t position, LINEAR_DS *src, size_t from, size_t count) {
+    Node *first;
+    Node *last;
+
+    if (list_nodes_compatible(dst, src)) {
+        first = list_unlink_chain(src, from, count, &last);
+        list_link_chain(dst, position, first, last, count);
+        return LDS_SUCCESS;
+    }
+    if (copy_elements(dst, position, src, from, count) != LDS_SUCCESS) {
+        return LDS_FAIL;
+    }
+    src->ops->remove_range(src, from, count, NULL);
+    return LDS_SUCCESS;
+}
+
+/* Copia count elementos (count > 0) de src, a partir de from, para a posio
+ * position de dst, sem alterar src. */
+static lds_return_t copy_elements(LINEAR_DS *dst, size_t position, LINEAR_DS *src, size_t from, size_t count) {
+    Node *first;
+    Node *last;
+    size_t i;
+
+    if (dst->type == LDS_VECTOR) {
+        if (vec_open_range(dst, position, count) != LDS_SUCCESS) {
+            return LDS_FAIL;
+        }
+        if (dst->stride == dst->data_size) {
+            /* Os elementos novos de dst ocupam no mximo dois trechos contguos. */
+            size_t index = vec_wrap(dst, dst->storage.head + position);
+            size_t first_count = dst->capacity - index < count ? dst->capacity - index : count;
+            src->ops->get_range(src, from, vec_slot(dst, index), first_count);
+            if (count > first_count) {
+                src->ops->get_range(src, from + first_count, vec_slot(dst, 0), count - first_count);
+            }
+        }
+        else {
+            for (i = 0; i < count; i++) {
+                src->ops->get(src, from + i, vec_at(dst, position + i));
+            }
+        }
+    }
+    else {
+        if (list_new_chain(dst, count, &first, &last) != LDS_SUCCESS) {
+            return LDS_FAIL;
+        }
+        Node *node;
+        for (node = first, i = 0; node != NULL; node = node->next, i++) {
+            src->ops->get(src, from + i, node->data);
+        }
+        list_link_chain(dst, position, first, last, count);
+    }
+    return LDS_SUCCESS;
+}
+
+/* Ns de src podem passar para dst sem cpia se tiverem o mesmo formato e a
+ * mesma origem, para que dst saiba liber-los. */
+static int list_nodes_compatible(LINEAR_DS *dst, LINEAR_DS *src) {
+    if (dst->type == LDS_VECTOR || dst->type != src->type || dst->data_size != src->data_size) {
+        return 0;
+    }
+    if (dst->pool != NULL || src->pool != NULL) {
+        return dst->pool == src->pool;
+    }
+    return dst->allocator == src->allocator;
+}
+
+/* Cria uma estrutura vazia do mesmo tipo e com a mesma configurao de ds. Uma
+ * lista usa o mesmo alocador e o mesmo pool; um vetor recebe a capacidade pedida. */
+static LINEAR_DS* new_empty_like(LINEAR_DS *ds, size_t capacity) {
+    const LDS_ALLOCATOR *allocator = derived_allocator(ds);
+    LINEAR_DS *copy = (LINEAR_DS*)mem_alloc(allocator, sizeof(LINEAR_DS));
+    if (copy == NULL) {
+        return NULL;
+    }
+    if (ds->type != LDS_VECTOR) {
+        init_list(copy, ds->data_size, allocator);
+        copy->type = ds->type;
+        copy->ops = ops_for(ds->type, ds->data_size);
+        copy->pool = ds->pool;
+        return copy;
+    }
+
+    if (ds->flags & LDS_FLAG_POW2) {
+        capacity = round_pow2(capacity);
+    }
+    if (init_vector(copy, capacity, ds->data_size, ds->stride, ds->alignment, allocator, 0, ds) != LDS_SUCCESS) {
+        mem_free(allocator, copy, sizeof(LINEAR_DS));
+        return NULL;
+    }
+    return copy;
+}
+
+/* Alocador das estruturas criadas a partir de ds (vises, cpias, divises): o
+ * de ds, exceto a memria travada das estruturas de tempo real, em que cada
+ * bloco custaria uma pgina travada e uma chamada ao sistema. */
+static const LDS_ALLOCATOR * derived_allocator(LINEAR_DS *ds) {
+    return ds->allocator == &locked_allocator ? &default_allocator : ds->allocator;
+}
+
+lds_return_t lds_remove_last(LINEAR_DS *ds, void *removed_element) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (ds->size == 0) {
+        return LDS_POS_ERR;
+    }
+    lds_return_t r = ds->ops->remove(ds, ds->size-1, removed_element);
+    print_debug(ds, "lds_remove_last");
+    return r;
+}
+
+void lds_free(LINEAR_DS *ds) {
+    print_debug(ds, "lds_free");
+    if (ds != NULL) {
+        ds->ops->free(ds);
+        if (!(ds->flags & LDS_FLAG_EXTERNAL)) {
+            mem_free(ds->allocator, ds, vec_header_size(ds->inline_capacity, ds->data_size));
+        }
+    }
+}
+
+/* Funes especficas para vetor */
+
+/* Traz para dentro do vetor circular um ndice que pode ter passado do fim
+ * (ndices nunca passam de duas vezes a capacidade). */
+static size_t vec_wrap(LINEAR_DS *ds, size_t index) {
+    if (ds->flags & LDS_FLAG_POW2) {
+        return index & (ds->capacity - 1);
+    }
+    return index % ds->capacity;
+}
+
+/* Endereo da posio fsica index do vetor. */
+static char * vec_slot(LINEAR_DS *ds, size_t index) {
+    return (char*)ds->storage.vector + index * ds->stride;
+}
+
+/* Endereo do elemento na posio lgica position. */
+static char * vec_at(LINEAR_DS *ds, size_t position) {
+    if ((ds->flags & LDS_FLAG_MIGRATING) && position - ds->migration->start < ds->migration->count) {
+        return vec_old_at(ds, position);
+    }
+    return vec_slot(ds, vec_wrap(ds, ds->storage.head + position));
+}
+
+/* Endereo, no vetor antigo, de uma posio lgica que ainda no migrou. */
+static char * vec_old_at(LINEAR_DS *ds, size_t position) {
+    VecMigration *m = ds->migration;
+    size_t index = m->head + (position - m->start);
+    if (index >= m->capacity) {
+        index -= m->capacity;
+    }
+    return (char*)m->vector + index * ds->stride;
+}
+
+/* Comea um crescimento incremental: os elementos ficam no vetor atual, que
+ * passa a ser o antigo, e migram aos poucos para um vetor novo. */
+static lds_return_t vec_start_migration(LINEAR_DS *ds, size_t new_capacity) {
+    if (ds->flags & LDS_FLAG_FIXED) {
+        return LDS_FAIL; /* Tempo real: a capacidade no muda */
+    }
+    VecMigration *m = (VecMigration*)mem_alloc(ds->allocator, sizeof(VecMigration));
+    if (m == NULL) {
+        return LDS_FAIL; /* Falha ao alocar memria */
+    }
+    void *new_vector = vec_buf_alloc(ds, new_capacity * ds->stride);
+    if (new_vector == NULL) {
+        mem_free(ds->allocator, m, sizeof(VecMigration));
+        return LDS_FAIL; /* Falha ao alocar memria */
+    }
+    m->vector = ds->storage.vector;
+    m->capacity = ds->capacity;
+    m->head = ds->storage.head;
+    m->start = 0;
+    m->count = ds->size;
+
+    /* A migrao precisa terminar antes que o vetor novo encha. */
+    size_t room = new_capacity - ds->size;
+    m->step = (ds->size + room - 1) / room;
+    if (m->step < LDS_MIGRATE_STEP) {
+        m->step = LDS_MIGRATE_STEP;
+    }
+
+    ds->migration = m;
+
+    ds->storage.vector = new_vector;
+    ds->capacity = new_capacity;
+    ds->storage.head = 0;
+    ds->storage.tail = vec_wrap(ds, ds->size);
+    ds->flags |= LDS_FLAG_MIGRATING;
+    return LDS_SUCCESS;
+}
+
+/* Migra at count elementos, a partir do fim do trecho que est no vetor antigo. */
+static void vec_migrate(LINEAR_DS *ds, size_t count) {
+    VecMigration *m = ds->migration;
+    while (count > 0 && m->count > 0) {
+        size_t position = m->start + m->count - 1;
+        memcpy(vec_slot(ds, vec_wrap(ds, ds->storage.head + position)), vec_old_at(ds, position), ds->data_size);
+        m->count--;
+        count--;
+    }
+    if (m->count == 0) {
+        vec_end_migration(ds);
+    }
+}
+
+static void vec_finish_migration(LINEAR_DS *ds) {
+    if (ds->flags & LDS_FLAG_MIGRATING) {
+        vec_migrate(ds, ds->migration->count);
+    }
+}
+
+/* Libera o vetor antigo e o estado da migrao, migrados ou no os elementos. */
+static void vec_end_migration(LINEAR_DS *ds) {
+    vec_buf_free(ds, ds->migration->vector, ds->migration->capacity * ds->stride);
+    mem_free(ds->allocator, ds->migration, sizeof(VecMigration));
+    ds->migration = NULL;
+    ds->flags &= ~LDS_FLAG_MIGRATING;
+}
+
+/* Altera a capacidade do vetor (nunca para menos que size), mantendo os
+ * elementos em ordem circular. */
+static lds_return_t vec_resize(LINEAR_DS *ds, size_t new_capacity) {
+    if (ds->flags & LDS_FLAG_FIXED) {
+        return LDS_FAIL; /* Tempo real: a capacidade no muda */
+    }
+    vec_finish_migration(ds);
+
+    size_t capacity = ds->capacity;
+    size_t head = ds->storage.head;
+    int is_inline = (ds->flags & LDS_FLAG_INLINE) != 0;
+
+    /* Para diminuir, ou para sair do buffer interno, copia os elementos para o
+     * incio de um novo vetor. */
+    if (new_capacity < capacity || is_inline) {
+        void *new_vector;
+        if (new_capacity <= ds->inline_capacity) {
+            if (is_inline) {
+                return LDS_SUCCESS; /* J est no buffer interno: nada a devolver */
+            }
+            /* Volta para o buffer interno, ocupando-o por inteiro. */
+            new_vector = vec_inline_buffer(ds);
+            if (!(ds->flags & LDS_FLAG_POW2)) {
+                new_capacity = ds->inline_capacity;
+            }
+            else {
+                while (new_capacity * 2 <= ds->inline_capacity) {
+                    new_capacity *= 2;
+                }
+            }
+        }
+        else {
+            new_vector = vec_buf_alloc(ds, new_capacity * ds->stride);
+            if (new_vector == NULL) {
+                return LDS_FAIL; /* Falha ao alocar memria */
+            }
+        }
+        size_t head_count = capacity - head < ds->size ? capacity - head : ds->size;
+        memcpy(new_vector, vec_slot(ds, head), head_count * ds->stride);
+        memcpy((char*)new_vector + head_count * ds->stride, vec_slot(ds, 0),
+               (ds->size - head_count) * ds->stride);
+        if (!is_inline) {
+            vec_buf_free(ds, ds->storage.vector, capacity * ds->stride);
+        }
+        if (new_vector == vec_inline_buffer(ds)) {
+            ds->flags |= LDS_FLAG_INLINE;
+        }
+        else {
+            ds->flags &= ~LDS_FLAG_INLINE;
+        }
+        ds->storage.vector = new_vector;
+        ds->capacity = new_capacity;
+        ds->storage.head = 0;
+        ds->storage.tail = vec_wrap(ds, ds->size);
+        return LDS_SUCCESS;
+    }
+
+    void *new_vector = vec_buf_realloc(ds, ds->storage.vector,
+                                       capacity * ds->stride, new_capacity * ds->stride);
+    if (new_vector == NULL) {
+        return LDS_FAIL; /* Falha ao realocar memria */
+    }
+    ds->storage.vector = new_vector;
+    ds->capacity = new_capacity;
+
+    /* Reorganiza o vetor caso o fim esteja antes do incio. */
+    if (head + ds->size > capacity) {
+        size_t head_count = capacity - head;            /* elementos de head at o fim antigo */
+        size_t tail_count = ds->size - head_count;      /* elementos que deram a volta */
+
+        /* Move o trecho mais curto que couber no espao novo. */
+        if (tail_count <= new_capacity - capacity && tail_count <= head_count) {
+            memmove(vec_slot(ds, capacity), vec_slot(ds, 0), tail_count * ds->stride);
+        }
+        else {
+            memmove(vec_slot(ds, new_capacity - head_count), vec_slot(ds, head), head_count * ds->stride);
+            ds->storage.head = new_capacity - head_count;
+        }
+    }
+    ds->storage.tail = vec_wrap(ds, ds->storage.head + ds->size);
+    return LDS_SUCCESS;
+}
+
+static size_t round_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+/* Capacidade aps o crescimento, segundo a poltica do vetor, para caber ao menos needed elementos. */
+static size_t vec_grown_capacity(LINEAR_DS *ds, size_t needed) {
+    const LDS_GROWTH_POLICY *policy = ds->growth_policy;
+    size_t capacity;
+    if (policy != NULL) {
+        capacity = (size_t)(ds->capacity * policy->growth_factor);
+        if (policy->max_increment > 0 && capacity > ds->capacity + policy->max_increment) {
+            capacity = ds->capacity + policy->max_increment;
+        }
+    }
+    else {
+        capacity = ds->capacity * 2;
+    }
+    if (capacity < needed) {
+        capacity = needed;
+    }
+    if (ds->flags & LDS_FLAG_POW2) {
+        capacity = round_pow2(capacity);
+    }
+    return capacity;
+}
+
+/* Devolve memria quando o vetor ficou abaixo do limite da poltica. A nova
+ * capacidade deixa folga de um crescimento, para no oscilar entre crescer e diminuir. */
+static void vec_shrink_by_policy(LINEAR_DS *ds) {
+    const LDS_GROWTH_POLICY *policy = ds->growth_policy;
+    if (policy == NULL || policy->shrink_threshold <= 0 || (ds->flags & LDS_FLAG_MIGRATING) ||
+        ds->size >= ds->capacity * policy->shrink_threshold) {
+        return;
+    }
+    size_t capacity = (size_t)(ds->size * policy->growth_factor);
+    if (capacity < policy->min_capacity) {
+        capacity = policy->min_capacity;
+    }
+    if (capacity <= ds->size) {
+        capacity = ds->size + 1;
+    }
+    if (ds->flags & LDS_FLAG_POW2) {
+        capacity = round_pow2(capacity);
+    }
+    if (capacity < ds->capacity) {
+        vec_resize(ds, capacity); /* Se falhar, o vetor continua vlido com a capacidade atual. */
+    }
+}
+
+lds_return_t lds_reserve(LINEAR_DS *ds, size_t capacity) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (ds->type != LDS_VECTOR || capacity <= ds->capacity) {
+        return LDS_SUCCESS;
+    }
+    if (ds->flags & LDS_FLAG_POW2) {
+        capacity = round_pow2(capacity);
+    }
+    lds_return_t r = vec_resize(ds, capacity);
+    print_debug(ds, "lds_reserve");
+    return r;
+}
+
+lds_return_t lds_shrink_to_fit(LINEAR_DS *ds) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (ds->type != LDS_VECTOR) {
+        return LDS_SUCCESS;
+    }
+    size_t capacity = ds->size > 0 ? ds->size : 1;
+    if (ds->flags & LDS_FLAG_POW2) {
+        capacity = round_pow2(capacity);
+    }
+    lds_return_t r = capacity < ds->capacity ? vec_resize(ds, capacity) : LDS_SUCCESS;
+    print_debug(ds, "lds_shrink_to_fit");
+    return r;
+}
+
+lds_return_t lds_set_growth_policy(LINEAR_DS *ds, const LDS_GROWTH_POLICY *policy) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (ds->type != LDS_VECTOR) {
+        return LDS_FAIL;
+    }
+    ds->growth_policy = policy;
+    return LDS_SUCCESS;
+}
+
+lds_return_t lds_set_incremental_growth(LINEAR_DS *ds) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (ds->type != LDS_VECTOR) {
+        return LDS_FAIL;
+    }
+    ds->flags |= LDS_FLAG_INCREMENTAL;
+    return LDS_SUCCESS;
+}
+
+lds_return_t lds_set_mmap_threshold(LINEAR_DS *ds, size_t bytes, int huge_pages) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+#ifndef LDS_HAVE_MMAP
+    if (bytes > 0) {
+        return LDS_FAIL; /* Sem suporte a mapeamentos nesta plataforma */
+    }
+#endif
+    if (ds->type != LDS_VECTOR || (ds->flags & LDS_FLAG_FIXED)) {
+        return LDS_FAIL;
+    }
+    vec_finish_migration(ds);
+
+    /* Se o vetor atual muda de lado do limite, troca-o j de tipo de memria,
+     * para que a liberao siga sempre a regra atual. */
+    size_t size = ds->capacity * ds->stride;
+    int was_mapped = vec_buf_is_mapped(ds, size);
+    size_t old_threshold = ds->mmap_threshold;
+    unsigned int old_flags = ds->flags;
+    ds->mmap_threshold = bytes;
+    if (huge_pages) {
+        ds->flags |= LDS_FLAG_HUGEPAGES;
+    }
+    else {
+        ds->flags &= ~LDS_FLAG_HUGEPAGES;
+    }
+    if (!(ds->flags & LDS_FLAG_INLINE) && vec_buf_is_mapped(ds, size) != was_mapped) {
+        void *new_vector = vec_buf_alloc(ds, size);
+        if (new_vector == NULL) {
+            ds->mmap_threshold = old_threshold;
+            ds->flags = old_flags;
+            return LDS_FAIL;
+        }
+        memcpy(new_vector, ds->storage.vector, size);
+        vec_buf_release(ds, ds->storage.vector, size, was_mapped);
+        ds->storage.vector = new_vector;
+    }
+    print_debug(ds, "lds_set_mmap_threshold");
+    return LDS_SUCCESS;
+}
+
+lds_return_t lds_set_pow2_capacity(LINEAR_DS *ds) {
+    if (ds == NULL) {
+        return LDS_NULL;
+    }
+    if (ds->type != LDS_VECTOR) {
+        return LDS_FAIL;
+    }
+    size_t capacity = round_pow2(ds->capacity);
+    if (capacity != ds->capacity && vec_resize(ds, capacity) != LDS_SUCCESS) {
+        return LDS_FAIL;
+    }
+    ds->flags |= LDS_FLAG_POW2;
+    print_debug(ds, "lds_set_pow2_capacity");
+    return LDS_SUCCESS;
+}
+
+/* Move count elementos da posio fsica src para dst; os dois trechos podem dar a
+ * volta no vetor e se sobrepor. Se dst estiver  frente de src e os trechos se
+ * sobrepuserem, copia de trs para frente; seno, de frente para trs. */
+static void vec_move(LINEAR_DS *ds, size_t dst, size_t src, size_t count) {
+    size_t capacity = ds->capacity;
+    size_t n;
+    if (count == 0 || dst == src) {
+        return;
+    }
+
+    if (vec_wrap(ds, dst + capacity - src) < count) {
+        size_t src_end = vec_wrap(ds, src + count);
+        size_t dst_end = vec_wrap(ds, dst + count);
+        while (count > 0) {
+            if (src_end == 0) {
+                src_end = capacity;
+            }
+            if (dst_end == 0) {
+                dst_end = capacity;
+            }
+            n = count;
+            if (n > src_end) {
+                n = src_end;
+            }
+            if (n > dst_end) {
+                n = dst_end;
+            }
+            src_end -= n;
+            dst_end -= n;
+            memmove(vec_slot(ds, dst_end), vec_slot(ds, src_end), n * ds->stride);
+            count -= n;
+        }
+    }
+    else {
+        while (count > 0) {
+            n = count;
+            if (n > capacity - src) {
+                n = capacity - src;
+            }
+            if (n > capacity - dst) {
+                n = capacity - dst;
+            }
+            memmove(vec_slot(ds, dst), vec_slot(ds, src), n * ds->stride);
+            src = vec_wrap(ds, src + n);
+            dst = vec_wrap(ds, dst + n);
+            count -= n;
+        }
+    }
+}
+
+static lds_return_t insert_element_in_vector(LINEAR_DS *ds, size_t position, void *value) {
+    return vec_insert_sized(ds, position, value, ds->data_size);
+}
+
+static lds_return_t remove_element_from_vector(LINEAR_DS *ds, size_t position, void *removed_element) {
+    return vec_remove_sized(ds, position, removed_element, ds->data_size);
+}
+
+/* Abre espao para um elemento na posio position e devolve o endereo dele,
+ * ou NULL se faltar memria. */
+static char * vec_make_room(LINEAR_DS *ds, size_t position) {
+    int at_end = position == 0 || position == ds->size;
+    if (ds->flags & LDS_FLAG_MIGRATING) {
+        if (at_end && ds->size < ds->capacity) {
+            return vec_room_while_migrating(ds, position);
+        }
+        vec_finish_migration(ds);
+    }
+    if (ds->size == ds->capacity) {
+        /* No modo incremental, inseres nas pontas no pagam a cpia de todo o vetor. */
+        if ((ds->flags & LDS_FLAG_INCREMENTAL) && !(ds->flags & LDS_FLAG_INLINE) && at_end && ds->size > 0) {
+            if (vec_start_migration(ds, vec_grown_capacity(ds, ds->size + 1)) != LDS_SUCCESS) {
+                return NULL;
+            }
+            return vec_room_while_migrating(ds, position);
+        }
+        if (vec_resize(ds, vec_grown_capacity(ds, ds->size + 1)) != LDS_SUCCESS) {
+            return NULL;
+        }
+    }
+
+    /* Abre espao deslocando o lado com menos elementos. */
+    if (position < ds->size - position) {
+        size_t head = vec_wrap(ds, ds->storage.head + ds->capacity - 1);
+        vec_move(ds, head, ds->storage.head, position);
+        ds->storage.head = head;
+    }
+    else {
+        size_t index = vec_wrap(ds, ds->storage.head + position);
+        vec_move(ds, vec_wrap(ds, index + 1), index, ds->size - position);
+        ds->storage.tail = vec_wrap(ds, ds->storage.tail + 1);
+    }
+
+    vec_iterator_inserted(ds, position, 1);
+    ds->size++;
+    return vec_at(ds, position);
+}
+
+/* Fecha o espao do elemento da posio position, que j foi copiado se preciso. */
+static void vec_close_gap(LINEAR_DS *ds, size_t position) {
+    if (ds->flags & LDS_FLAG_MIGRATING) {
+        if (position == 0 || position == ds->size - 1) {
+            vec_close_while_migrating(ds, position);
+            return;
+        }
+        vec_finish_migration(ds);
+    }
+
+    /* Fecha o espao deslocando o lado com menos elementos. */
+    if (position < ds->size - 1 - position) {
+        size_t head = vec_wrap(ds, ds->storage.head + 1);
+        vec_move(ds, head, ds->storage.head, position);
+        ds->storage.head = head;
+    }
+    else {
+        size_t index = vec_wrap(ds, ds->storage.head + position);
+        vec_move(ds, index, vec_wrap(ds, index + 1), ds->size - 1 - position);
+        ds->storage.tail = vec_wrap(ds, ds->storage.tail + ds->capacity - 1);
+    }
+    vec_iterator_removed(ds, position, 1);
+    ds->size--;
+    vec_shrink_by_policy(ds);
+}
+
+/* Insero numa das pontas durante a migrao. O elemento novo vai sempre para
+ * o vetor novo; em seguida, migra mais alguns elementos. */
+static char * vec_room_while_migrating(LINEAR_DS *ds, size_t position) {
+    char *slot;
+    if (position == 0) {
+        ds->storage.head = vec_wrap(ds, ds->storage.head + ds->capacity - 1);
+        ds->migration->start++;
+        slot = vec_slot(ds, ds->storage.head);
+    }
+    else {
+        slot = vec_slot(ds, ds->storage.tail);
+        ds->storage.tail = vec_wrap(ds, ds->storage.tail + 1);
+    }
+    vec_iterator_inserted(ds, position, 1);
+    ds->size++;
+    vec_migrate(ds, ds->migration->step); /* No toca no vetor novo fora das posies migradas */
+    return slot;
+}
+
+/* Remoo numa das pontas durante a migrao. */
+static void vec_close_while_migrating(LINEAR_DS *ds, size_t position) {
+    VecMigration *m = ds->migration;
+    if (position == 0) {
+        if (m->start == 0) {
+            /* O primeiro elemento ainda estava no vetor antigo. */
+            m->head = m->head + 1 == m->capacity ? 0 : m->head + 1;
+            m->count--;
+        }
+        else {
+            m->start--;
+        }
+        ds->storage.head = vec_wrap(ds, ds->storage.head + 1);
+    }
+    else {
+        if (position - m->start < m->count) {
+            m->count--; /* O ltimo elemento ainda estava no vetor antigo. */
+        }
+        ds->storage.tail = vec_wrap(ds, ds->storage.tail + ds->capacity - 1);
+    }
+    vec_iterator_removed(ds, position, 1);
+    ds->size--;
+    vec_migrate(ds, m->step);
+}
+
+static lds_return_t get_element_from_vector(LINEAR_DS *ds, size_t position, void *element) {
+    return vec_get_sized(ds, position, element, ds->data_size);
+}
+
+static lds_return_t set_element_in_vector(LINEAR_DS *ds, size_t position, void *value) {
+    return vec_set_sized(ds, position, value, ds->data_size);
+}
+
+static lds_return_t set_nocmp_in_vector(LINEAR_DS *ds, size_t position, void *value) {
+    memcpy(vec_at(ds, position), value, ds->data_size);
+    return LDS_SUCCESS;
+}
+
+static void * ref_in_vector(LINEAR_DS *ds, size_t position) {
+    return vec_at(ds, position);
+}
+
+static void * emplace_in_vector(LINEAR_DS *ds, size_t position) {
+    return vec_make_room(ds, position);
+}
+
+static lds_return_t insert_range_in_vector(LINEAR_DS *ds, size_t position, const void *src, size_t count) {
+    if (vec_open_range(ds, position, count) != LDS_SUCCESS) {
+        return LDS_FAIL; /* Falha ao alocar memria, ou vetor de tempo real cheio */
+    }
+    vec_write(ds, position, (const char*)src, count);
+    return LDS_SUCCESS;
+}
+
+/* Abre espao para count elementos a partir da posio position, sem copi-los. */
+static lds_return_t vec_open_range(LINEAR_DS *ds, size_t position, size_t count) {
+    /* A migrao incremental s trata inseres de um elemento nas pontas. */
+    vec_finish_migration(ds);
+    if (count > ds->capacity - ds->size) {
+        if (vec_resize(ds, vec_grown_capacity(ds, ds->size + count)) != LDS_SUCCESS) {
+            return LDS_FAIL;
+        }
+    }
+
+    /* Abre espao para todos os elementos de uma vez, deslocando o lado com menos elementos. */
+    if (position < ds->size - position) {
+        size_t head = vec_wrap(ds, ds->storage.head + ds->capacity - count);
+        vec_move(ds, head, ds->storage.head, position);
+        ds->storage.head = head;
+    }
+    else {
+        size_t index = vec_wrap(ds, ds->storage.head + position);
+        vec_move(ds, vec_wrap(ds, index + count), index, ds->size - position);
+        ds->storage.tail = vec_wrap(ds, ds->storage.tail + count);
+    }
+    vec_iterator_inserted(ds, position, count);
+    ds->size += count;
+    return LDS_SUCCESS;
+}
+
+static lds_return_t get_range_from_vector(LINEAR_DS *ds, size_t position, void *dst, size_t count) {
+    vec_read(ds, position, (char*)dst, count);
+    return LDS_SUCCESS;
+}
+
+static lds_return_t remove_range_from_vector(LINEAR_DS *ds, size_t position, size_t count, void *removed) {
+    vec_finish_migration(ds);
+    if (removed != NULL) {
+        vec_read(ds, position, (char*)removed, count);
+    }
+
+    /* Fecha o espao de uma vez, deslocando o lado com menos elementos. */
+    if (position < ds->size - count - position) {
+        size_t head = vec_wrap(ds, ds->storage.head + count);
+        vec_move(ds, head, ds->storage.head, position);
+        ds->storage.head = head;
+    }
+    else {
+        size_t index = vec_wrap(ds, ds->storage.head + position);
+        vec_move(ds, index, vec_wrap(ds, index + count), ds->size - count - position);
+        ds->storage.tail = vec_wrap(ds, ds->storage.tail + ds->capacity - count);
+    }
+    vec_iterator_removed(ds, position, count);
+    ds->size -= count;
+    vec_shrink_by_policy(ds);
+    return LDS_SUCCESS;
+}
+
+/* Ajustam o iterador embutido quando count elementos entram ou saem a partir
+ * de position, com a regra das listas (ver cursor_inserted() e cursor_removed()):
+ * ele continua no mesmo elemento; se este saiu, passa ao primeiro depois do
+ * trecho; se estava aps o ltimo, na posio da insero, passa ao primeiro
+ * elemento novo. Chamadas antes de ds->size mudar. */
+static void vec_iterator_inserted(LINEAR_DS *ds, size_t position, size_t count) {
+    size_t *it_position = &ds->iterator.position;
+    if (*it_position >= position && !(*it_position == position && position == ds->size)) {
+        *it_position += count;
+    }
+}
+
+static void vec_iterator_removed(LINEAR_DS *ds, size_t position, size_t count) {
+    size_t *it_position = &ds->iterator.position;
+    if (*it_position >= position + count) {
+        *it_position -= count;
+    }
+    else if (*it_position > position) {
+        *it_position = position;
+    }
+}
+
+/* Esvazia o vetor sem mexer na capacidade. */
+static void clear_vector(LINEAR_DS *ds) {
+    if (ds->flags & LDS_FLAG_MIGRATING) {
+        vec_end_migration(ds);
+    }
+    ds->storage.head = 0;
+    ds->storage.tail = 0;
+    ds->size = 0;
+    ds->iterator.position = 0;
+}
+
+/* Copia count elementos contguos de src para as posies lgicas a partir de
+ * position. Sem preenchimento entre os elementos, so no mximo duas cpias. */
+static void vec_write(LINEAR_DS *ds, size_t position, const char *src, size_t count) {
+    size_t i;
+    if (!(ds->flags & LDS_FLAG_MIGRATING) && ds->stride == ds->data_size) {
+        size_t index = vec_wrap(ds, ds->storage.head + position);
+        size_t first = ds->capacity - index < count ? ds->capacity - index : count;
+        memcpy(vec_slot(ds, index), src, first * ds->stride);
+        memcpy(vec_slot(ds, 0), src + first * ds->stride, (count - first) * ds->stride);
+        return;
+    }
+    for (i = 0; i < count; i++) {
+        memcpy(vec_at(ds, position + i), src + i * ds->data_size, ds->data_size);
+    }
+}
+
+/* Copia count elementos a partir da posio lgica position para dst, sem preenchimento. */
+static void vec_read(LINEAR_DS *ds, size_t position, char *dst, size_t count) {
+    size_t i;
+    if (!(ds->flags & LDS_FLAG_MIGRATING) && ds->stride == ds->data_size) {
+        size_t index = vec_wrap(ds, ds->storage.head + position);
+        size_t first = ds->capacity - index < count ? ds->capacity - index : count;
+        memcpy(dst, vec_slot(ds, index), first * ds->stride);
+        memcpy(dst + first * ds->stride, vec_slot(ds, 0), (count - first) * ds->stride);
+        return;
+    }
+    for (i = 0; i < count; i++) {
+        memcpy(dst + i * ds->data_size, vec_at(ds, position + i), ds->data_size);
+    }
+}
+
+static void free_vector(LINEAR_DS *ds) {
+    if (ds->flags & LDS_FLAG_MIGRATING) {
+        vec_end_migration(ds);
+    }
+    if (!(ds->flags & LDS_FLAG_INLINE)) {
+        vec_buf_free(ds, ds->storage.vector, ds->capacity * ds->stride);
+    }
+}
+
+/* Tamanho do bloco da estrutura, incluindo o buffer interno do vetor pequeno. */
+static size_t vec_header_size(size_t inline_capacity, size_t data_size) {
+    if (inline_capacity == 0) {
+        return sizeof(LINEAR_DS);
+    }
+    return vec_inline_offset() + inline_capacity * data_size;
+}
+
+static size_t vec_inline_offset(void) {
+    return (sizeof(LINEAR_DS) + _Alignof(max_align_t) - 1) / _Alignof(max_align_t) * _Alignof(max_align_t);
+}
+
+static void * vec_inline_buffer(LINEAR_DS *ds) {
+    return (char*)ds + vec_inline_offset();
+}
+
+static lds_return_t insert_element_in_list(LINEAR_DS *ds, size_t position, void *value) {
+    return list_insert_sized(ds, position, value, ds->data_size);
+}
+
+static lds_return_t remove_element_from_list(LINEAR_DS *ds, size_t position, void *removed_element) {
+    return list_remove_sized(ds, position, removed_element, ds->data_size);
+}
+
+static lds_return_t get_element_from_list(LINEAR_DS *ds, size_t position, void *element) {
+    return list_get_sized(ds, position, element, ds->data_size);
+}
+
+static lds_return_t set_element_in_list(LINEAR_DS *ds, size_t position, void *value) {
+    return list_set_sized(ds, position, value, ds->data_size);
+}
+
+static lds_return_t set_nocmp_in_list(LINEAR_DS *ds, size_t position, void *value) {
+    memcpy(ref_in_list(ds, position), value, ds->data_size);
+    return LDS_SUCCESS;
+}
+
+static void * ref_in_list(LINEAR_DS *ds, size_t position) {
+    ds->ops->it_go(&ds->seek, position);
+    return ds->seek.current->data;
+}
+
+static void * emplace_in_list(LINEAR_DS *ds, size_t position) {
+    Node *node = list_make_room(ds, position);
+    return node != NULL ? node->data : NULL;
+}
+
+static lds_return_t insert_range_in_list(LINEAR_DS *ds, size_t position, const void *src, size_t count) {
+    Node *first;
+    Node *last;
+    Node *node;
+    size_t i;
+
+    /* Monta a cadeia inteira antes de tocar na lista: se faltar memria, ela fica como estava. */
+    if (list_new_chain(ds, count, &first, &last) != LDS_SUCCESS) {
+        return LDS_FAIL; /* Falha ao alocar memria, ou pool esgotado */
+    }
+    for (node = first, i = 0; node != NULL; node = node->next, i++) {
+        memcpy(node->data, (const char*)src + i * ds->data_size, ds->data_size);
+    }
+    list_link_chain(ds, position, first, last, count);
+    return LDS_SUCCESS;
+}
+
+/* Aloca count ns (count > 0), encadeados entre si e ainda sem dado. Se faltar
+ * memria, libera os que j tinha alocado. */
+static lds_return_t list_new_chain(LINEAR_DS *ds, size_t count, Node **first, Node **last) {
+    size_t i;
+    *first = NULL;
+    *last = NULL;
+    for (i = 0; i < count; i++) {
+        Node *node = new_node(ds);
+        if (node == NULL) {
+            while (*first != NULL) {
+                Node *next = (*first)->next;
+                free_node(ds, *first);
+                *first = next;
+            }
+            return LDS_FAIL;
+        }
+        node->next = NULL;
+        if (ds->type == LDS_DOUBLY_LINKED_LIST) {
+            NODE_PREV(node) = *last;
+        }
+        if (*last != NULL) {
+            (*last)->next = node;
+        }
+        else {
+            *first = node;
+        }
+        *last = node;
+    }
+    return LDS_SUCCESS;
+}
+
+/* Encadeia na posio position a cadeia de count ns que vai de first a last. */
+static void list_link_chain(LINEAR_DS *ds, size_t position, Node *first, Node *last, size_t count) {
+    LDSIterator *it = &ds->seek;
+
+    /* Uma nica busca pela posio; nas pontas, nenhuma. */
+    Node *before;
+    Node *after;
+    if (position == 0) {
+        before = NULL;
+        after = ds->storage.list.first;
+    }
+    else if (position == ds->size) {
+        before = ds->storage.list.last;
+        after = NULL;
+    }
+    else {
+        ds->ops->it_go(it, position);
+        before = it->previous;
+        after = it->current;
+    }
+
+    last->next = after;
+    if (before != NULL) {
+        before->next = first;
+    }
+    else {
+        ds->storage.list.first = first;
+    }
+    if (after == NULL) {
+        ds->storage.list.last = last;
+    }
+    if (ds->type == LDS_DOUBLY_LINKED_LIST) {
+        NODE_PREV(first) = before;
+        if (after != NULL) {
+            NODE_PREV(after) = last;
+        }
+    }
+
+    list_cursors_inserted(ds, NULL, position, count, first, last);
+    ds->size += count;
+}
+
+static lds_return_t get_range_from_list(LINEAR_DS *ds, size_t position, void *dst, size_t count) {
+    ds->ops->it_go(&ds->seek, position);
+    Node *node = ds->seek.current;
+    size_t i;
+    for (i = 0; i < count; i++) {
+        memcpy((char*)dst + i * ds->data_size, node->data, ds->data_size);
+        node = node->next;
+    }
+    return LDS_SUCCESS;
+}
+
+static lds_return_t remove_range_from_list(LINEAR_DS *ds, size_t position, size_t count, void *removed) {
+    Node *last;
+    Node *node = list_unlink_chain(ds, position, count, &last);
+    size_t i;
+    for (i = 0; i < count; i++) {
+        Node *next = node->next;
+        if (removed != NULL) {
+            memcpy((char*)removed + i * ds->data_size, node->data, ds->data_size);
+        }
+        free_node(ds, node);
+        node = next;
+    }
+    return LDS_SUCCESS;
+}
+
+/* Desencadeia os count ns (count > 0) a partir da posio position e devolve o
+ * primeiro; o ltimo vai para *last. Os ns continuam encadeados entre si. */
+static Node * list_unlink_chain(LINEAR_DS *ds, size_t position, size_t count, Node **last) {
+    LDSIterator *it = &ds->seek;
+    Node *before;
+    Node *first;
+    size_t i;
+
+    /* Uma nica busca pela posio; o trecho que vai at o fim no  percorrido. */
+    if (position == 0) {
+        before = NULL;
+        first = ds->storage.list.first;
+    }
+    else {
+        ds->ops->it_go(it, position);
+        before = it->previous;
+        first = it->current;
+    }
+    if (position + count == ds->size) {
+        *last = ds->storage.list.last;
+    }
+    else {
+        *last = first;
+        for (i = 1; i < count; i++) {
+            *last = (*last)->next;
+        }
+    }
+    Node *after = (*last)->next;
+    (*last)->next = NULL;
+
+    if (before != NULL) {
+        before->next = after;
+    }
+    else {
+        ds->storage.list.first = after;
+    }
+    if (after == NULL) {
+        ds->storage.list.last = before;
+    }
+    else if (ds->type == LDS_DOUBLY_LINKED_LIST) {
+        NODE_PREV(after) = before;
+    }
+
+    list_cursors_removed(ds, NULL, position, count, before, after);
+    ds->size -= count;
+    return first;
+}
+
+static void clear_list(LINEAR_DS *ds) {
+    list_release_nodes(ds);
+    ds->storage.list.first = NULL;
+    ds->storage.list.last = NULL;
+    ds->size = 0;
+    it_reset_in_list(&ds->iterator);
+    it_reset_in_list(&ds->seek);
+}
+
+/* Encadeia um n novo, ainda sem dado, na posio position. Devolve NULL se faltar memria. */
+static Node * list_make_room(LINEAR_DS *ds, size_t position) {
+    /* Inseres nas pontas no precisam percorrer a lista. */
+    if (position == ds->size || position == 0) {
+        Node *node = new_node(ds);
+        if (node == NULL) {
+            return NULL;
+        }
+        if (position == ds->size) {
+            list_link_last(ds, node);
+        }
+        else {
+            list_link_first(ds, node);
+        }
+        return node;
+    }
+
+    ds->ops->it_go(&ds->seek, position);
+    return it_link_new_node(&ds->seek);
+}
+
+/* Desencadeia o n da posio position e o devolve; quem chama o libera. */
+static Node * list_detach(LINEAR_DS *ds, size_t position) {
+    /* Remoo do incio (ou do fim, na lista dupla) no precisa percorrer a lista. */
+    if (position == 0) {
+        return list_unlink_first(ds);
+    }
+    if (position == ds->size - 1 && ds->type == LDS_DOUBLY_LINKED_LIST) {
+        return list_unlink_last(ds);
+    }
+
+    ds->ops->it_go(&ds->seek, position);
+    return it_unlink(&ds->seek);
+}
+
+static void free_list(LINEAR_DS *ds) {
+    list_release_nodes(ds);
+    if (ds->flags & LDS_FLAG_OWNS_POOL) {
+        lds_free_node_pool(ds->pool);
+    }
+}
+
+/* Libera todos os ns, sem atualizar a lista. */
+static void list_release_nodes(LINEAR_DS *ds) {
+    /* Alocador sem liberao (arena): no h por que percorrer os ns. */
+    if (ds->pool == NULL && ds->allocator->free == NULL) {
+        return;
+    }
+
+    /* Com pool, a cadeia inteira volta para a lista livre de uma vez. */
+    if (ds->pool != NULL) {
+        if (ds->storage.list.first != NULL) {
+            ds->storage.list.last->next = ds->pool->free_nodes;
+            ds->pool->free_nodes = ds->storage.list.first;
+            ds->pool->in_use -= ds->size;
+        }
+        return;
+    }
+
+    Node *current = ds->storage.list.first;
+    while (current != NULL) {
+        Node *next = current->next;
+        free_node(ds, current);
+        current = next;
+    }
+}
+
+/* Ajusta um cursor depois que count ns, de first a last, entram na posio
+ * position: ele continua no mesmo elemento. Um cursor aps o ltimo passa ao
+ * primeiro n novo, como um consumidor de fila que espera novos elementos. */
+static void cursor_inserted(LDSIterator *it, size_t position, size_t count, Node *first, Node *last) {
+    if (it->position == position && it->current == NULL) {
+        it->current = first;
+    }
+    else if (it->position >= position) {
+        if (it->position == position) {
+            it->previous = last;
+        }
+        it->position += count;
+    }
+}
+
+/* Ajusta um cursor depois que count ns saem a partir da posio position, entre
+ * before e after: ele continua no mesmo elemento ou, se este saiu, passa a after. */
+static void cursor_removed(LDSIterator *it, size_t position, size_t count, Node *before, Node *after) {
+    if (it->position >= position) {
+        if (it->position < position + count) {
+            it->current = after;
+            it->position = position + count;
+        }
+        it->position -= count;
+        if (it->position == position) {
+            it->previous = before;
+        }
+    }
+}
+
+/* Depois de uma alterao estrutural, ajusta os cursores que a estrutura conhece:
+ * o iterador embutido e o cursor de busca. except  o cursor que fez a alterao,
+ * j ajustado por ela. Cursores do usurio (LDS_CURSOR) no so ajustados. */
+static void list_cursors_inserted(LINEAR_DS *ds, LDSIterator *except, size_t position, size_t count,
+                                  Node *first, Node *last) {
+    if (&ds->iterator != except) {
+        cursor_inserted(&ds->iterator, position, count, first, last);
+    }
+    if (&ds->seek != except) {
+        cursor_inserted(&ds->seek, position, count, first, last);
+    }
+}
+
+static void list_cursors_removed(LINEAR_DS *ds, LDSIterator *except, size_t position, size_t count,
+                                 Node *before, Node *after) {
+    if (&ds->iterator != except) {
+        cursor_removed(&ds->iterator, position, count, before, after);
+    }
+    if (&ds->seek != except) {
+        cursor_removed(&ds->seek, position, count, before, after);
+    }
+}
+
+/* Encadeamento direto nas pontas da lista, usado pelas operaes de fila e pilha. */
+static void list_link_last(LINEAR_DS *ds, Node *node) {
+    node->next = NULL;
+    if (ds->type == LDS_DOUBLY_LINKED_LIST) {
+        NODE_PREV(node) = ds->storage.list.last;
+    }
+    if (ds->storage.list.last != NULL) {
+        ds->storage.list.last->next = node;
+    }
+    else {
+        ds->storage.list.first = node;
+    }
+    ds->storage.list.last = node;
+    list_cursors_inserted(ds, NULL, ds->size, 1, node, node);
+    ds->size++;
+}
+
+static void list_link_first(LINEAR_DS *ds, Node *node) {
+    node->next = ds->storage.list.first;
+    if (ds->type == LDS_DOUBLY_LINKED_LIST) {
+        NODE_PREV(node) = NULL;
+        if (node->next != NULL) {
+            NODE_PREV(node->next) = node;
+        }
+    }
+    ds->storage.list.first = node;
+    if (ds->storage.list.last == NULL) {
+        ds->storage.list.last = node;
+    }
+    list_cursors_inserted(ds, NULL, 0, 1, node, node);
+    ds->size++;
+}
+
+static Node * list_unlink_first(LINEAR_DS *ds) {
+    Node *removed = ds->storage.list.first;
+    ds->storage.list.first = removed->next;
+    if (ds->storage.list.last == removed) {
+        ds->storage.list.last = NULL;
     }
-    if (position > ds->size || position < 0) {
-        return LDS_POS_ERR;
+    else if (ds->type == LDS_DOUBLY_LINKED_LIST) {
+        NODE_PREV(removed->next) = NULL;
     }
-    lds_return_t r = ds->insert(ds, position, value);
-    print_debug(ds, "lds_insert");
-    return r;
+    list_cursors_removed(ds, NULL, 0, 1, NULL, removed->next);
+    ds->size--;
+    return removed;
 }
 
-
-lds_return_t lds_insert_last(LINEAR_DS *ds, void *value) {
-    return lds_insert(ds, ds->size, value);
+/* Somente para lista dupla. */
+static Node * list_unlink_last(LINEAR_DS *ds) {
+    Node *removed = ds->storage.list.last;
+    ds->storage.list.last = NODE_PREV(removed);
+    if (ds->storage.list.last != NULL) {
+        ds->storage.list.last->next = NULL;
+    }
+    else {
+        ds->storage.list.first = NULL;
+    }
+    list_cursors_removed(ds, NULL, ds->size - 1, 1, ds->storage.list.last, NULL);
+    ds->size--;
+    return removed;
 }
 
-lds_return_t lds_get(LINEAR_DS *ds, size_t position, void *element) {
-    if (ds == NULL || element == NULL) {
-        return LDS_NULL;
-    }
-    if (position >= ds->size || position < 0) {
-        return LDS_POS_ERR;
+/* Um nico bloco guarda o encadeamento e o dado do n. */
+static Node * new_node(LINEAR_DS *ds) {
+    if (ds->pool != NULL) {
+        return pool_get_node(ds->pool);
     }
-    lds_return_t r = ds->get(ds, position, element);
-    print_debug(ds, "lds_get");
-    return r;
+    size_t prefix = node_prefix(ds);
+    char *block = (char*)mem_alloc(ds->allocator, prefix + sizeof(Node) + ds->data_size);
+    return block != NULL ? (Node*)(block + prefix) : NULL;
 }
 
-lds_return_t lds_set(LINEAR_DS *ds, size_t position, void *value) {
-    if (ds == NULL || value == NULL) {
-        return LDS_NULL;
+static void free_node(LINEAR_DS *ds, Node *node) {
+    if (ds->pool != NULL) {
+        pool_put_node(ds->pool, node);
     }
-    if (position >= ds->size || position < 0) {
-        return LDS_POS_ERR;
+    else {
+        size_t prefix = node_prefix(ds);
+        mem_free(ds->allocator, (char*)node - prefix, prefix + sizeof(Node) + ds->data_size);
     }
-    lds_return_t r = ds->set(ds, position, value);
-    print_debug(ds, "lds_set");
-    return r;
 }
 
-lds_return_t lds_remove(LINEAR_DS *ds, size_t position, void *removed_element) {
-    if (ds == NULL) {
-        return LDS_NULL;
-    }
-    if (position >= ds->size || position < 0) {
-        return LDS_POS_ERR;
+/* Alinhamento de que o dado precisa. O tamanho de um tipo  mltiplo do seu
+ * alinhamento, ento basta a maior potncia de 2 que divide data_size,
+ * limitada  de max_align_t (a garantida pelo alocador). */
+static size_t node_data_alignment(size_t data_size) {
+    size_t alignment = data_size & (~data_size + 1);
+    if (alignment == 0 || alignment > _Alignof(max_align_t)) {
+        alignment = _Alignof(max_align_t);
     }
-    lds_return_t r = ds->remove(ds, position, removed_element);
-    print_debug(ds, "lds_remove");
-    return r;
+    return alignment;
 }
 
-lds_return_t lds_remove_last(LINEAR_DS *ds, void *removed_element) {
-    if (ds == NULL) {
-        return LDS_NULL;
+/* Espao reservado antes do Node: o ponteiro ao anterior, nas listas duplas,
+ * mais o necessrio para que o dado fique alinhado num bloco que comea
+ * alinhado a max_align_t. */
+static size_t node_prefix_for(int doubly_linked, size_t data_size) {
+    size_t alignment = node_data_alignment(data_size);
+    size_t before_data = (doubly_linked ? sizeof(Node*) : 0) + offsetof(Node, data);
+    return (before_data + alignment - 1) / alignment * alignment - offsetof(Node, data);
+}
+
+static size_t node_prefix(LINEAR_DS *ds) {
+    return node_prefix_for(ds->type == LDS_DOUBLY_LINKED_LIST, ds->data_size);
+}
+
+/* Funes de pool de ns */
+LDS_NODE_POOL * lds_new_node_pool(size_t data_size, size_t nodes_per_chunk) {
+    return lds_new_node_pool_ex(data_size, nodes_per_chunk, NULL);
+}
+
+LDS_NODE_POOL * lds_new_node_pool_ex(size_t data_size, size_t nodes_per_chunk, const LDS_ALLOCATOR *allocator) {
+    if (allocator == NULL) {
+        allocator = &default_allocator;
     }
-    lds_return_t r = ds->remove(ds, ds->size-1, removed_element);
-    print_debug(ds, "lds_remove_last");
-    return r;
+    LDSNodePool *pool = (LDSNodePool*)mem_alloc(allocator, sizeof(LDSNodePool));
+    if (pool == NULL) {
+        return NULL; /* Falha ao alocar memria */
+    }
+    pool->allocator = allocator;
+    pool->chunks = NULL;
+    pool->free_nodes = NULL;
+    pool->data_size = data_size;
+    /* Mantm os ns e seus dados alinhados dentro do bloco (os pools s servem listas simples) */
+    size_t alignment = node_data_alignment(data_size);
+    if (alignment < sizeof(Node*)) {
+        alignment = sizeof(Node*);
+    }
+    pool->node_offset = node_prefix_for(0, data_size);
+    pool->node_size = (pool->node_offset + sizeof(Node) + data_size + alignment - 1) / alignment * alignment;
+    pool->nodes_per_chunk = nodes_per_chunk > 0 ? nodes_per_chunk : 1;
+    pool->in_use = 0;
+    pool->high_water = 0;
+    pool->fixed = 0;
+    return pool;
 }
 
-void lds_free(LINEAR_DS *ds) {
-    print_debug(ds, "lds_free");
+LINEAR_DS* lds_new_list_from_pool(LDS_NODE_POOL *pool) {
+    if (pool == NULL) {
+        return NULL;
+    }
+    LINEAR_DS *ds = lds_new_list_ex(pool->data_size, pool->allocator);
     if (ds != NULL) {
-        ds->free(ds);
-        free(ds);
+        ds->pool = pool;
     }
+    return ds;
 }
 
-/* Funes especficas para vetor */
-static lds_return_t insert_element_in_vector(LINEAR_DS *ds, size_t position, void *value) {
-    if (ds->size == ds->capacity) {
-        size_t new_capacity = ds->capacity > 0 ? ds->capacity * 2 : 1;
-        void *new_vector = realloc(ds->storage.vector, new_capacity * ds->data_size);
-        if (new_vector == NULL) {
-            return LDS_FAIL; /* Falha ao realocar memria */
-        }
+size_t lds_node_pool_high_water(LDS_NODE_POOL *pool) {
+    return pool != NULL ? pool->high_water : 0;
+}
 
-        /* Reorganiza o vetor caso o fim esteja antes do incio. */
-        if (ds->storage.head >= ds->storage.tail) {
-            memmove((char*)new_vector + ds->capacity * ds->data_size,
-                    new_vector, ds->storage.tail * ds->data_size);
-            ds->storage.tail = ds->capacity + ds->storage.tail;
+size_t lds_node_pool_trim(LDS_NODE_POOL *pool) {
+    if (pool == NULL) {
+        return 0;
+    }
+    size_t chunk_bytes = pool_chunk_bytes(pool);
+    PoolChunk *chunk;
+    Node *node;
+
+    /* Com blocos e ns livres ordenados por endereo, os ns de cada bloco ficam
+     * seguidos, e uma nica passada conjunta acha o bloco de cada n. */
+    pool->chunks = pool_sort_chunks(pool->chunks);
+    pool->free_nodes = pool_sort_nodes(pool->free_nodes);
+
+    /* Conta os ns livres de cada bloco. */
+    for (chunk = pool->chunks; chunk != NULL; chunk = chunk->next) {
+        chunk->free_count = 0;
+    }
+    chunk = pool->chunks;
+    for (node = pool->free_nodes; node != NULL; node = node->next) {
+        while ((unsigned char*)node >= chunk->nodes + chunk_bytes) {
+            chunk = chunk->next;
         }
+        chunk->free_count++;
+    }
 
-        ds->storage.vector = new_vector;
-        ds->capacity = new_capacity;
+    /* Refaz a lista livre, na mesma ordem, sem os ns dos blocos que sero liberados. */
+    Node **tail = &pool->free_nodes;
+    chunk = pool->chunks;
+    node = pool->free_nodes;
+    while (node != NULL) {
+        Node *next = node->next;
+        while ((unsigned char*)node >= chunk->nodes + chunk_bytes) {
+            chunk = chunk->next;
+        }
+        if (chunk->free_count < pool->nodes_per_chunk) {
+            *tail = node;
+            tail = &node->next;
+        }
+        node = next;
+    }
+    *tail = NULL;
+
+    size_t released = 0;
+    PoolChunk **link = &pool->chunks;
+    while (*link != NULL) {
+        chunk = *link;
+        if (chunk->free_count == pool->nodes_per_chunk) {
+            *link = chunk->next;
+            mem_free(pool->allocator, chunk, sizeof(PoolChunk) + chunk_bytes);
+            released++;
+        }
+        else {
+            link = &chunk->next;
+        }
     }
+    return released;
+}
 
-    if (position == ds->size) {
-        memcpy((char*)ds->storage.vector + (ds->storage.tail * ds->data_size), value, ds->data_size);
-        ds->storage.tail = (ds->storage.tail + 1) % ds->capacity;
-    } else if (position == 0) {
-        ds->storage.head = (ds->storage.head - 1 + ds->capacity) % ds->capacity;
-        memcpy((char*)ds->storage.vector + ds->storage.head * ds->data_size, value, ds->data_size);
-    } else {
-        size_t index = (ds->storage.head + position) % ds->capacity;
-        size_t tail = ds->storage.tail;
+void lds_free_node_pool(LDS_NODE_POOL *pool) {
+    if (pool != NULL) {
+        PoolChunk *chunk = pool->chunks;
+        while (chunk != NULL) {
+            PoolChunk *next = chunk->next;
+            mem_free(pool->allocator, chunk, sizeof(PoolChunk) + pool_chunk_bytes(pool));
+            chunk = next;
+        }
+        mem_free(pool->allocator, pool, sizeof(LDSNodePool));
+    }
+}
 
-        /* Fim est depois da insero. */
-        if (tail > index) {
-            memmove((char*)ds->storage.vector + (index + 1) * ds->data_size,
-                    (char*)ds->storage.vector + index * ds->data_size,
-                    (tail-index) * ds->data_size);
+static Node * pool_get_node(LDSNodePool *pool) {
+    if (pool->free_nodes == NULL) {
+        if (pool->fixed || pool_add_chunk(pool) != LDS_SUCCESS) {
+            return NULL; /* Pool esgotado ou falha ao alocar memria */
         }
+    }
 
-        /* Fim est antes da insero */
-        else {
-            /* Movimenta o comeo para a direita */
-            memmove((char*)ds->storage.vector + 1 * ds->data_size,
-                    (char*)ds->storage.vector,
-                    tail * ds->data_size);
-            /* Movimenta o ltimo para o primeiro. */
-            memmove((char*)ds->storage.vector,
-                    (char*)ds->storage.vector + (ds->capacity - 1) * ds->data_size,
-                    ds->data_size);
-            /* Movimenta o fim para a direita. */
-            memmove((char*)ds->storage.vector + (index + 1) * ds->data_size,
-                    (char*)ds->storage.vector + index * ds->data_size,
-                    (ds->capacity - index - 1) * ds->data_size);
-        }
-
-        memcpy((char*)ds->storage.vector + index * ds->data_size,
-               value, ds->data_size);
-        ds->storage.tail = (ds->storage.tail + 1) % ds->capacity;
+    Node *node = pool->free_nodes;
+    pool->free_nodes = node->next;
+    pool->in_use++;
+    if (pool->in_use > pool->high_water) {
+        pool->high_water = pool->in_use;
     }
-    ds->size++;
-    return LDS_SUCCESS;
+    return node;
 }
 
-static lds_return_t remove_element_from_vector(LINEAR_DS *ds, size_t position, void *removed_element) {
-    if (removed_element != NULL) {
-        memcpy(removed_element, (char*)ds->storage.vector + ((ds->storage.head + position) % ds->capacity) * ds->data_size, ds->data_size);
-    }
-
-    if (position == ds->size - 1) {
-        ds->storage.tail = (ds->storage.tail - 1 + ds->capacity) % ds->capacity;
-    } else if (position == 0) {
-        ds->storage.head = (ds->storage.head + 1) % ds->capacity;
-    } else {
-        size_t index = (ds->storage.head + position) % ds->capacity;
-        size_t tail = ds->storage.tail;
-
-        /* Move  esquerda */
-        if (tail > index) {
-            memmove((char*)ds->storage.vector + index * ds->data_size,
-                    (char*)ds->storage.vector + (index + 1) * ds->data_size,
-                    (tail - index - 1) * ds->data_size);
-            ds->storage.tail = (ds->storage.tail - 1 + ds->capacity) % ds->capacity;
-        } else {
-            memmove((char*)ds->storage.vector + (ds->storage.head + 1) * ds->data_size,
-                    (char*)ds->storage.vector + ds->storage.head * ds->data_size,
-                    position * ds->data_size);
-            ds->storage.head = (ds->storage.head + 1) % ds->capacity;
-        }
+/* Obtm mais um bloco e encadeia todos os seus ns na lista livre. */
+static lds_return_t pool_add_chunk(LDSNodePool *pool) {
+    PoolChunk *chunk = (PoolChunk*)mem_alloc(pool->allocator, sizeof(PoolChunk) + pool_chunk_bytes(pool));
+    if (chunk == NULL) {
+        return LDS_FAIL; /* Falha ao alocar memria */
+    }
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    size_t i;
+    for (i = pool->nodes_per_chunk; i > 0; i--) {
+        Node *node = (Node*)(chunk->nodes + (i - 1) * pool->node_size + pool->node_offset);
+        node->next = pool->free_nodes;
+        pool->free_nodes = node;
     }
-    ds->size--;
     return LDS_SUCCESS;
 }
 
-static lds_return_t get_element_from_vector(LINEAR_DS *ds, size_t position, void *element) {
-    memcpy(element, (char*)ds->storage.vector + ((ds->storage.head + position) % ds->capacity) * ds->data_size, ds->data_size);
-    return LDS_SUCCESS;
+static void pool_put_node(LDSNodePool *pool, Node *node) {
+    node->next = pool->free_nodes;
+    pool->free_nodes = node;
+    pool->in_use--;
 }
 
-static lds_return_t set_element_in_vector(LINEAR_DS *ds, size_t position, void *value) {
-    if (memcmp(value, (char*)ds->storage.vector + ((ds->storage.head + position) % ds->capacity) * ds->data_size, ds->data_size) == 0) {
-        return LDS_FAIL;
-    }
+static size_t pool_chunk_bytes(LDSNodePool *pool) {
+    return pool->node_size * pool->nodes_per_chunk;
+}
 
-    memcpy((char*)ds->storage.vector + ((ds->storage.head + position) % ds->capacity) * ds->data_size, value, ds->data_size);
-    return LDS_SUCCESS;
+/* Ordenam por endereo, com merge sort, a lista livre e a lista de blocos
+ * do pool: O(n log n), sem memria extra. */
+static Node * pool_sort_nodes(Node *list) {
+    if (list == NULL || list->next == NULL) {
+        return list;
+    }
+    Node *middle = list, *end = list->next;
+    while (end != NULL && end->next != NULL) {
+        middle = middle->next;
+        end = end->next->next;
+    }
+    Node *a = middle->next;
+    middle->next = NULL;
+    Node *b = pool_sort_nodes(a);
+    a = pool_sort_nodes(list);
+
+    Node *sorted = NULL, **tail = &sorted;
+    while (a != NULL && b != NULL) {
+        if ((uintptr_t)a < (uintptr_t)b) {
+            *tail = a;
+            a = a->next;
+        }
+        else {
+            *tail = b;
+            b = b->next;
+        }
+        tail = &(*tail)->next;
+    }
+    *tail = a != NULL ? a : b;
+    return sorted;
 }
 
-static void free_vector(LINEAR_DS *ds) {
-    free(ds->storage.vector);
+static PoolChunk * pool_sort_chunks(PoolChunk *list) {
+    if (list == NULL || list->next == NULL) {
+        return list;
+    }
+    PoolChunk *middle = list, *end = list->next;
+    while (end != NULL && end->next != NULL) {
+        middle = middle->next;
+        end = end->next->next;
+    }
+    PoolChunk *a = middle->next;
+    middle->next = NULL;
+    PoolChunk *b = pool_sort_chunks(a);
+    a = pool_sort_chunks(list);
+
+    PoolChunk *sorted = NULL, **tail = &sorted;
+    while (a != NULL && b != NULL) {
+        if ((uintptr_t)a < (uintptr_t)b) {
+            *tail = a;
+            a = a->next;
+        }
+        else {
+            *tail = b;
+            b = b->next;
+        }
+        tail = &(*tail)->next;
+    }
+    *tail = a != NULL ? a : b;
+    return sorted;
 }
 
-static lds_return_t insert_element_in_list(LINEAR_DS *ds, size_t position, void *value) {
-    lds_return_t r = it_go_in_list(&ds->iterator, position);
-    if (r == LDS_SUCCESS) {
-        return it_add_in_list(&ds->iterator, value);
+/* Funes de arena */
+LDS_ARENA * lds_new_arena(size_t chunk_size) {
+    LDSArena *arena = (LDSArena*)malloc(sizeof(LDSArena));
+    if (arena == NULL) {
+        return NULL; /* Falha ao alocar memria */
     }
-    return r;
+    arena->allocator.alloc = arena_alloc;
+    arena->allocator.realloc = arena_realloc;
+    arena->allocator.free = NULL;
+    arena->allocator.context = arena;
+    arena->chunks = NULL;
+    arena->chunk_size = chunk_size;
+    arena->last = NULL;
+    return arena;
 }
 
-static lds_return_t remove_element_from_list(LINEAR_DS *ds, size_t position, void *removed_element) {
-    lds_return_t r = it_go_in_list(&ds->iterator, position);
-    if (r == LDS_SUCCESS) {
-        return it_remove_from_list(&ds->iterator, removed_element);
+const LDS_ALLOCATOR * lds_arena_allocator(LDS_ARENA *arena) {
+    return arena != NULL ? &arena->allocator : NULL;
+}
+
+void lds_arena_reset(LDS_ARENA *arena) {
+    if (arena != NULL && arena->chunks != NULL) {
+        ArenaChunk *chunk = arena->chunks->next;
+        while (chunk != NULL) {
+            ArenaChunk *next = chunk->next;
+            free(chunk);
+            chunk = next;
+        }
+        arena->chunks->next = NULL;
+        arena->chunks->used = 0;
+        arena->last = NULL;
     }
-    return r;
 }
 
-static lds_return_t get_element_from_list(LINEAR_DS *ds, size_t position, void *element) {
-    lds_return_t r = it_go_in_list(&ds->iterator, position);
-    if (r == LDS_SUCCESS) {
-        return it_get_from_list(&ds->iterator, element);
+void lds_free_arena(LDS_ARENA *arena) {
+    if (arena != NULL) {
+        ArenaChunk *chunk = arena->chunks;
+        while (chunk != NULL) {
+            ArenaChunk *next = chunk->next;
+            free(chunk);
+            chunk = next;
+        }
+        free(arena);
     }
-    return r;
 }
 
-static lds_return_t set_element_in_list(LINEAR_DS *ds, size_t position, void *value) {
-    lds_return_t r = it_go_in_list(&ds->iterator, position);
-    if (r == LDS_SUCCESS) {
-        return it_set_in_list(&ds->iterator, value);
+/* Mantm todos os blocos com o alinhamento de malloc() */
+static size_t arena_round(size_t size) {
+    return (size + _Alignof(max_align_t) - 1) / _Alignof(max_align_t) * _Alignof(max_align_t);
+}
+
+static void * arena_alloc(void *context, size_t size) {
+    LDSArena *arena = (LDSArena*)context;
+    size = arena_round(size);
+
+    ArenaChunk *chunk = arena->chunks;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        size_t chunk_size = size > arena->chunk_size ? size : arena->chunk_size;
+        ArenaChunk *new_chunk = (ArenaChunk*)malloc(sizeof(ArenaChunk) + chunk_size);
+        if (new_chunk == NULL) {
+            return NULL; /* Falha ao alocar memria */
+        }
+        new_chunk->size = chunk_size;
+        new_chunk->used = 0;
+
+        /* Blocos grandes ganham um pedao prprio, sem descartar o bloco corrente. */
+        if (chunk != NULL && chunk_size > arena->chunk_size) {
+            new_chunk->next = chunk->next;
+            chunk->next = new_chunk;
+            new_chunk->used = size;
+            return new_chunk->data;
+        }
+        new_chunk->next = chunk;
+        arena->chunks = chunk = new_chunk;
     }
-    return r;
+
+    void *ptr = (char*)chunk->data + chunk->used;
+    chunk->used += size;
+    arena->last = ptr;
+    return ptr;
 }
 
-static void free_list(LINEAR_DS *ds) {
-    Node *current = ds->storage.list.first;
-    while (current != NULL) {
-        Node *next = current->next;
-        free(current->data);
-        free(current);
-        current = next;
+static void * arena_realloc(void *context, void *ptr, size_t old_size, size_t new_size) {
+    LDSArena *arena = (LDSArena*)context;
+    ArenaChunk *chunk = arena->chunks;
+
+    /* O ltimo bloco entregue cresce no lugar enquanto houver espao no bloco corrente. */
+    if (ptr != NULL && ptr == arena->last) {
+        size_t offset = (size_t)((char*)ptr - (char*)chunk->data);
+        size_t size = arena_round(new_size);
+        if (size <= chunk->size - offset) {
+            chunk->used = offset + size;
+            return ptr;
+        }
+    }
+
+    void *new_ptr = arena_alloc(context, new_size);
+    if (new_ptr != NULL && ptr != NULL) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
     }
+    return new_ptr;
 }
 
 /* Funes para consultar os campos da estrutura */
@@ -475,6 +3063,10 @@ size_t lds_capacity(LINEAR_DS *ds) {
     return (ds != NULL || ds->type == LDS_VECTOR) ? ((LINEAR_DS*)ds)->capacity : 0;
 }
 
+size_t lds_sizeof_handle(void) {
+    return sizeof(LINEAR_DS);
+}
+
 size_t lds_data_size(LINEAR_DS *ds) {
     return ds != NULL ? ((LINEAR_DS*)ds)->data_size : 0;
 }
@@ -488,6 +3080,18 @@ LDS_ITERATOR * lds_iterator(LINEAR_DS *ds) {
     return &ds->iterator;
 }
 
+LDS_ITERATOR * lds_cursor_init(LDS_CURSOR *cursor, LINEAR_DS *ds) {
+    if (cursor == NULL || ds == NULL) {
+        return NULL;
+    }
+    LDSIterator *it = (LDSIterator*)cursor;
+    it->ds = ds;
+    it->current = NULL;
+    it->previous = NULL;
+    ds->ops->it_reset(it);
+    return it;
+}
+
 size_t lds_it_position(LDS_ITERATOR *it) {
     return it->position;
 }
@@ -496,17 +3100,31 @@ lds_return_t lds_it_add(LDS_ITERATOR *it, void *value) {
     if (it == NULL || value == NULL) {
         return LDS_NULL;
     }
-    return it->add(it, value);
+    /* Um cursor de vetor pode ter ficado alm do fim depois de remoes. */
+    if (it->position > it->ds->size) {
+        return LDS_POS_ERR;
+    }
+    return it->ds->ops->it_add(it, value);
 }
 
 lds_return_t lds_it_next(LDS_ITERATOR *it) {
     if (it == NULL) {
         return LDS_NULL;
     }
-    if (it->position == it->ds->size) {
+    if (it->position >= it->ds->size) {
+        return LDS_POS_ERR;
+    }
+    return it->ds->ops->it_next(it);
+}
+
+lds_return_t lds_it_prev(LDS_ITERATOR *it) {
+    if (it == NULL) {
+        return LDS_NULL;
+    }
+    if (it->position == 0) {
         return LDS_POS_ERR;
     }
-    return it->next(it);
+    return it->ds->ops->it_prev(it);
 }
 
 lds_return_t lds_it_has_next(LDS_ITERATOR *it) {
@@ -520,38 +3138,56 @@ lds_return_t lds_it_get(LDS_ITERATOR *it, void *element) {
     if (it == NULL || element == NULL) {
         return LDS_NULL;
     }
-    if (it->position == it->ds->size) {
+    if (it->position >= it->ds->size) {
         return LDS_POS_ERR;
     }
-    return it->get(it, element);
+    return it->ds->ops->it_get(it, element);
+}
+
+
+void * lds_it_ref(LDS_ITERATOR *it) {
+    if (it == NULL || it->position >= it->ds->size) {
+        return NULL;
+    }
+    return it->ds->ops->it_ref(it);
 }
 
+size_t lds_it_next_span(LDS_ITERATOR *it, void **data) {
+    if (it == NULL || data == NULL) {
+        return 0;
+    }
+    if (it->position >= it->ds->size) {
+        *data = NULL;
+        return 0;
+    }
+    return it->ds->ops->it_span(it, data);
+}
 
 lds_return_t lds_it_set(LDS_ITERATOR *it, void *value) {
     if (it == NULL || value == NULL) {
         return LDS_NULL;
     }
-    if (it->position == it->ds->size) {
+    if (it->position >= it->ds->size) {
         return LDS_POS_ERR;
     }
-    return it->set(it, value);
+    return it->ds->ops->it_set(it, value);
 }
 
 lds_return_t lds_it_remove(LDS_ITERATOR *it, void *removed_element) {
     if (it == NULL) {
         return LDS_NULL;
     }
-    if (it->position == it->ds->size) {
+    if (it->position >= it->ds->size) {
         return LDS_POS_ERR;
     }
-    return it->remove(it, removed_element);
+    return it->ds->ops->it_remove(it, removed_element);
 }
 
 lds_return_t lds_it_reset(LDS_ITERATOR *it) {
     if (it == NULL) {
         return LDS_NULL;
     }
-    return it->reset(it);
+    return it->ds->ops->it_reset(it);
 }
 
 
@@ -562,41 +3198,57 @@ lds_return_t lds_it_go(LDS_ITERATOR *it, size_t pos) {
     if (pos > it->ds->size) {
         return LDS_POS_ERR;
     }
-    return it->go(it, pos);
+    return it->ds->ops->it_go(it, pos);
 }
 
 static lds_return_t it_add_in_vector(LDS_ITERATOR *it, void *value) {
-    return insert_element_in_vector(it->ds, it->position, value);
+    /* Como na lista, o iterador que insere fica na posio, agora no elemento novo. */
+    size_t position = it->position;
+    lds_return_t r = insert_element_in_vector(it->ds, position, value);
+    it->position = position;
+    return r;
 }
 
 static lds_return_t it_add_in_list(LDS_ITERATOR *it, void *value) {
-    Node *new_node = (Node*)malloc(sizeof(Node));
-    if (new_node == NULL) {
+    Node *node = it_link_new_node(it);
+    if (node == NULL) {
         return LDS_FAIL;
     }
-    new_node->data = malloc(it->ds->data_size);
-    if (new_node->data == NULL) {
-        free(new_node);
-        return LDS_FAIL;
+    memcpy(node->data, value, it->ds->data_size);
+    return LDS_SUCCESS;
+}
+
+/* Encadeia um n novo, ainda sem dado, na posio do iterador. */
+static Node * it_link_new_node(LDS_ITERATOR *it) {
+    Node *node = new_node(it->ds);
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (it->ds->type == LDS_DOUBLY_LINKED_LIST) {
+        NODE_PREV(node) = it->previous;
+        if (it->current != NULL) {
+            NODE_PREV(it->current) = node;
+        }
     }
-    memcpy(new_node->data, value, it->ds->data_size);
 
-    new_node->next = it->current;
+    node->next = it->current;
     if (it->previous != NULL) {
-        it->previous->next = new_node;
+        it->previous->next = node;
     }
-    it->current = new_node;
+    it->current = node;
 
     if (it->position == 0) {
-        it->ds->storage.list.first = new_node;
+        it->ds->storage.list.first = node;
     }
 
     if (it->position == it->ds->size) {
-        it->ds->storage.list.last = new_node;
+        it->ds->storage.list.last = node;
     }
 
+    list_cursors_inserted(it->ds, it, it->position, 1, node, node);
     it->ds->size++;
-    return LDS_SUCCESS;
+    return node;
 }
 
 static lds_return_t it_next_in_vector(LDS_ITERATOR *it) {
@@ -611,16 +3263,29 @@ static lds_return_t it_next_in_list(LDS_ITERATOR *it) {
     return LDS_SUCCESS;
 }
 
+static lds_return_t it_prev_in_vector(LDS_ITERATOR *it) {
+    it->position--;
+    return LDS_SUCCESS;
+}
+
+static lds_return_t it_prev_in_list(LDS_ITERATOR *it) {
+    /* Sem encadeamento para trs: percorre desde o incio. */
+    return it_go_in_list(it, it->position - 1);
+}
+
+static lds_return_t it_prev_in_dlist(LDS_ITERATOR *it) {
+    it->position--;
+    it->current = it->previous;
+    it->previous = NODE_PREV(it->previous);
+    return LDS_SUCCESS;
+}
+
 static lds_return_t it_get_from_vector(LDS_ITERATOR *it, void *element) {
     return get_element_from_vector(it->ds, it->position, element);
 }
 
 static lds_return_t it_get_from_list(LDS_ITERATOR *it, void *element) {
-    if (it->position >= it->ds->size) {
-        return LDS_POS_ERR;
-    }
-    memcpy(element, it->current->data, it->ds->data_size);
-    return LDS_SUCCESS;
+    return it_get_list_sized(it, element, it->ds->data_size);
 }
 
 static lds_return_t it_remove_from_vector(LDS_ITERATOR *it, void *removed_element) {
@@ -628,9 +3293,22 @@ static lds_return_t it_remove_from_vector(LDS_ITERATOR *it, void *removed_elemen
 }
 
 static lds_return_t it_remove_from_list(LDS_ITERATOR *it, void *removed_element) {
-    if (it->current == NULL) {
+    Node *removed = it_unlink(it);
+    if (removed == NULL) {
         return LDS_POS_ERR;
     }
+    if (removed_element != NULL) {
+        memcpy(removed_element, removed->data, it->ds->data_size);
+    }
+    free_node(it->ds, removed);
+    return LDS_SUCCESS;
+}
+
+/* Desencadeia o n da posio do iterador e o devolve, ou NULL se no houver. */
+static Node * it_unlink(LDS_ITERATOR *it) {
+    if (it->current == NULL) {
+        return NULL;
+    }
 
     Node * removed = it->current;
     it->current = it->current->next;
@@ -638,6 +3316,9 @@ static lds_return_t it_remove_from_list(LDS_ITERATOR *it, void *removed_element)
     if (it->previous != NULL) {
         it->previous->next = it->current;
     }
+    if (it->ds->type == LDS_DOUBLY_LINKED_LIST && it->current != NULL) {
+        NODE_PREV(it->current) = it->previous;
+    }
 
     if (it->ds->storage.list.first == removed) {
         it->ds->storage.list.first = it->current;
@@ -646,15 +3327,9 @@ static lds_return_t it_remove_from_list(LDS_ITERATOR *it, void *removed_element)
         it->ds->storage.list.last = it->previous;
     }
 
-    if (removed_element != NULL) {
-        memcpy(removed_element, removed->data, it->ds->data_size);
-    }
-
-    free(removed->data);
-    free(removed);
+    list_cursors_removed(it->ds, it, it->position, 1, it->previous, it->current);
     it->ds->size--;
-
-    return LDS_SUCCESS;
+    return removed;
 }
 
 static lds_return_t it_reset_in_vector(LDS_ITERATOR *it) {
@@ -684,17 +3359,141 @@ static lds_return_t it_go_in_list(LDS_ITERATOR *it, size_t position) {
     return LDS_SUCCESS;
 }
 
+/* Parte do incio, do fim ou da posio atual, o que estiver mais perto. */
+static lds_return_t it_go_in_dlist(LDS_ITERATOR *it, size_t position) {
+    size_t size = it->ds->size;
+    size_t from_current = position > it->position ? position - it->position : it->position - position;
+
+    if (position < from_current) {
+        it_reset_in_list(it);
+    }
+    else if (size - position < from_current) {
+        it->position = size;
+        it->current = NULL;
+        it->previous = it->ds->storage.list.last;
+    }
+
+    while (it->position < position) {
+        it_next_in_list(it);
+    }
+    while (it->position > position) {
+        it_prev_in_dlist(it);
+    }
+    return LDS_SUCCESS;
+}
+
 
 static lds_return_t it_set_in_vector(LDS_ITERATOR *it, void *value) {
     return set_element_in_vector(it->ds, it->position, value);
 }
 static lds_return_t it_set_in_list(LDS_ITERATOR *it, void *value) {
-    if (memcmp(value, it->current->data, it->ds->data_size) == 0) {
-        return LDS_FAIL;
+    return it_set_list_sized(it, value, it->ds->data_size);
+}
+
+static void * it_ref_in_vector(LDS_ITERATOR *it) {
+    return vec_at(it->ds, it->position);
+}
+
+static void * it_ref_in_list(LDS_ITERATOR *it) {
+    return it->current->data;
+}
+
+/* No vetor circular h no mximo dois trechos: at o fim do buffer e depois do
+ * incio. Durante a migrao, a parte que est no vetor antigo  tratada  parte. */
+static size_t it_span_in_vector(LDS_ITERATOR *it, void **data) {
+    LINEAR_DS *ds = it->ds;
+    size_t position = it->position;
+    size_t count = ds->size - position;
+    size_t index;
+
+    VecMigration *m = ds->migration;
+
+    if ((ds->flags & LDS_FLAG_MIGRATING) && position - m->start < m->count) {
+        index = m->head + (position - m->start);
+        if (index >= m->capacity) {
+            index -= m->capacity;
+        }
+        if (count > m->start + m->count - position) {
+            count = m->start + m->count - position;
+        }
+        if (count > m->capacity - index) {
+            count = m->capacity - index;
+        }
+        *data = (char*)m->vector + index * ds->stride;
+    }
+    else {
+        index = vec_wrap(ds, ds->storage.head + position);
+        if (count > ds->capacity - index) {
+            count = ds->capacity - index;
+        }
+        if ((ds->flags & LDS_FLAG_MIGRATING) && position < m->start && count > m->start - position) {
+            count = m->start - position;
+        }
+        *data = vec_slot(ds, index);
     }
+    it->position += count;
+    return count;
+}
 
-    memcpy(it->current->data, value, it->ds->data_size);
-    return LDS_SUCCESS;
+/* Na lista, cada n  um trecho. */
+static size_t it_span_in_list(LDS_ITERATOR *it, void **data) {
+    *data = it->current->data;
+    it_next_in_list(it);
+    return 1;
+}
+
+/* Funes de viso: uma viso no altera a estrutura de origem. */
+static lds_return_t insert_in_view(LINEAR_DS *ds, size_t position, void *value) {
+    (void)ds; (void)position; (void)value;
+    return LDS_FAIL;
+}
+
+static lds_return_t remove_from_view(LINEAR_DS *ds, size_t position, void *removed_element) {
+    (void)ds; (void)position; (void)removed_element;
+    return LDS_FAIL;
+}
+
+static lds_return_t set_in_view(LINEAR_DS *ds, size_t position, void *value) {
+    (void)ds; (void)position; (void)value;
+    return LDS_FAIL;
+}
+
+static void * emplace_in_view(LINEAR_DS *ds, size_t position) {
+    (void)ds; (void)position;
+    return NULL;
+}
+
+static lds_return_t insert_range_in_view(LINEAR_DS *ds, size_t position, const void *src, size_t count) {
+    (void)ds; (void)position; (void)src; (void)count;
+    return LDS_FAIL;
+}
+
+static lds_return_t remove_range_from_view(LINEAR_DS *ds, size_t position, size_t count, void *removed) {
+    (void)ds; (void)position; (void)count; (void)removed;
+    return LDS_FAIL;
+}
+
+/* A memria dos elementos  da estrutura de origem; da viso, s a cpia do
+ * estado da migrao. */
+static void free_view(LINEAR_DS *ds) {
+    if (ds->flags & LDS_FLAG_MIGRATING) {
+        mem_free(ds->allocator, ds->migration, sizeof(VecMigration));
+    }
+}
+
+static lds_return_t it_add_in_view(LDS_ITERATOR *it, void *value) {
+    (void)it; (void)value;
+    return LDS_FAIL;
+}
+
+static lds_return_t it_set_in_view(LDS_ITERATOR *it, void *value) {
+    (void)it; (void)value;
+    return LDS_FAIL;
+}
+
+static lds_return_t it_remove_from_view(LDS_ITERATOR *it, void *removed_element) {
+    (void)it; (void)removed_element;
+    return LDS_FAIL;
 }
 
 /* Funes de pilha */
@@ -367,24 +367,187 @@ typedef enum {
      */
     LDS_LINKED_LIST = 2,
 
+    /**
+     * @brief Data structure stores elements in a doubly linked list,
+     * non-contiguous, that can be walked in both directions.
+     */
+    LDS_DOUBLY_LINKED_LIST = 4,
+
     /**
      * @brief Data structure type is unknown.
      */
     LDS_UNKNOWN = LDS_NULL
 } lds_type_t;
 
+/**
+ * @struct LDS_GROWTH_POLICY
+ * @brief Rules used by a vector to grow and to give memory back.
+ *
+ * When a vector is full, its capacity is multiplied by `growth_factor`, but it never grows by
+ * more than `max_increment` elements at once (if `max_increment` is greater than zero).
+ *
+ * When `shrink_threshold` is greater than zero and, after a removal, the number of elements falls
+ * below `capacity * shrink_threshold`, the capacity is reduced to `size * growth_factor` (but not
+ * below `min_capacity`). Use a threshold smaller than `1 / growth_factor`, so that a vector does
+ * not shrink right after it grew.
+ *
+ * The structure is not copied by the library: it must remain valid while it is in use.
+ *
+ * @code
+ * static const LDS_GROWTH_POLICY bursty = { 1.5, 1024 * 1024, 0.25, 64 };
+ * lds_set_growth_policy(queue, &bursty);
+ * @endcode
+ * @see lds_set_growth_policy
+ */
+typedef struct {
+    /**
+     * @brief Factor applied to the capacity when the vector is full (for example, 1.5 or 2.0).
+     */
+    double growth_factor;
+
+    /**
+     * @brief Maximum number of elements added by one growth. Zero means no limit.
+     */
+    size_t max_increment;
+
+    /**
+     * @brief Fraction of the capacity below which the vector shrinks. Zero disables shrinking.
+     */
+    double shrink_threshold;
+
+    /**
+     * @brief Capacity below which automatic shrinking never goes.
+     */
+    size_t min_capacity;
+} LDS_GROWTH_POLICY;
+
 /**
  * @typedef LINEAR_DS
  * @brief Definition of the opaque data structure for linear data structures.
  */
 typedef struct LinearDS LINEAR_DS;
 
+/**
+ * @brief Number of bytes reserved for a LINEAR_DS header placed in caller-provided storage.
+ *
+ * It is an upper bound of lds_sizeof_handle(), checked when the library is compiled.
+ * @see LDS_HANDLE_STORAGE
+ */
+#define LDS_HANDLE_SIZE (32 * sizeof(void*))
+
+/**
+ * @union LDS_HANDLE_STORAGE
+ * @brief Storage, with the required size and alignment, for a LINEAR_DS header owned by the caller.
+ *
+ * It can be declared as a member of a user structure, as a local or as a static variable, and
+ * then be initialized with lds_init_vector() or lds_init_list(). Its contents must not be accessed
+ * directly; use the LINEAR_DS pointer returned by the initialization function.
+ *
+ * @code
+ * typedef struct {
+ *     int id;
+ *     LDS_HANDLE_STORAGE queue_storage;
+ *     LINEAR_DS *queue;
+ * } SESSION;
+ *
+ * session->queue = lds_init_list(&session->queue_storage, sizeof(int), NULL);
+ * // ...
+ * lds_destroy(session->queue);
+ * @endcode
+ */
+typedef union {
+    max_align_t align;                    /**< Forces the alignment of the storage. */
+    unsigned char bytes[LDS_HANDLE_SIZE]; /**< Room for the header. */
+} LDS_HANDLE_STORAGE;
+
 /**
  * @typedef LDS_ITERATOR
  * @brief Definition of the opaque iterator.
  */
 typedef struct LDSIterator LDS_ITERATOR;
 
+/**
+ * @brief Number of bytes reserved for a cursor.
+ * @see LDS_CURSOR
+ */
+#define LDS_CURSOR_SIZE (4 * sizeof(void*))
+
+/**
+ * @union LDS_CURSOR
+ * @brief Storage, owned by the caller, for an additional iterator over a linear data structure.
+ *
+ * A structure has one built-in iterator (lds_iterator()). A cursor is another iterator, small
+ * enough to be declared as a local variable, initialized with lds_cursor_init(); any number of
+ * cursors can traverse the same structure at the same time. Its contents must not be accessed
+ * directly; use the LDS_ITERATOR pointer returned by lds_cursor_init().
+ *
+ * @code
+ * // Merges two sorted lists of ints into out.
+ * LDS_CURSOR ca, cb;
+ * LDS_ITERATOR *a = lds_cursor_init(&ca, list_a);
+ * LDS_ITERATOR *b = lds_cursor_init(&cb, list_b);
+ * int x, y;
+ * while (lds_it_get(a, &x) == LDS_SUCCESS && lds_it_get(b, &y) == LDS_SUCCESS) {
+ *     if (x <= y) { lds_insert_last(out, &x); lds_it_next(a); }
+ *     else        { lds_insert_last(out, &y); lds_it_next(b); }
+ * }
+ * @endcode
+ */
+typedef union {
+    void *align;                          /**< Forces the alignment of the storage. */
+    unsigned char bytes[LDS_CURSOR_SIZE]; /**< Room for the iterator. */
+} LDS_CURSOR;
+
+/**
+ * @typedef LDS_NODE_POOL
+ * @brief Definition of the opaque pool of linked list nodes.
+ */
+typedef struct LDSNodePool LDS_NODE_POOL;
+
+/**
+ * @typedef LDS_ARENA
+ * @brief Definition of the opaque arena, a bump allocator for LINEAR_DS structures.
+ */
+typedef struct LDSArena LDS_ARENA;
+
+/**
+ * @struct LDS_ALLOCATOR
+ * @brief Set of functions used to obtain and release all the memory of a LINEAR_DS.
+ *
+ * Every function receives the `context` pointer as its first argument, so the allocator can keep
+ * its own state (an arena, a counter, a jemalloc arena index, etc.). The sizes of the blocks are
+ * always informed, so allocators that do not keep block headers can still work.
+ *
+ * The structure is not copied by the library: it must remain valid while any container or pool
+ * created with it exists.
+ *
+ * Blocks must be aligned as malloc() aligns them (to `_Alignof(max_align_t)`): list nodes keep
+ * their elements inside them, and references to elements rely on that alignment.
+ */
+typedef struct {
+    /**
+     * @brief Allocates a block of `size` bytes. Returns NULL when there is no memory available.
+     */
+    void *(*alloc)(void *context, size_t size);
+
+    /**
+     * @brief Resizes the block `ptr` from `old_size` to `new_size` bytes, keeping its contents.
+     * Returns NULL, leaving `ptr` untouched, when there is no memory available.
+     * If it is NULL, the library allocates a new block, copies the contents and frees the old one.
+     */
+    void *(*realloc)(void *context, void *ptr, size_t old_size, size_t new_size);
+
+    /**
+     * @brief Releases the block `ptr` of `size` bytes. If it is NULL, blocks are never released.
+     */
+    void (*free)(void *context, void *ptr, size_t size);
+
+    /**
+     * @brief User pointer passed to every function of the allocator.
+     */
+    void *context;
+} LDS_ALLOCATOR;
+
 
 /* Funes de criao e destruio */
 
@@ -414,6 +577,251 @@ LINEAR_DS* lds_new_vector(size_t initial_capacity, size_t data_size);
  */
 LINEAR_DS* lds_new_list(size_t data_size);
 
+/**
+ * @brief Creates a new linear data structure using an array (vector), with a custom allocator.
+ *
+ * It behaves exactly as lds_new_vector(), but the structure and its storage are allocated,
+ * resized and released through `allocator`.
+ *
+ * @param initial_capacity Initial capacity of the array for storing elements.
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param allocator Allocator used for all the memory of the structure. If it is NULL, the
+ * standard malloc(), realloc() and free() are used.
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*).
+ * @see LDS_ALLOCATOR
+ * @see lds_new_vector
+ */
+LINEAR_DS* lds_new_vector_ex(size_t initial_capacity, size_t data_size, const LDS_ALLOCATOR *allocator);
+
+/**
+ * @brief Creates a new linear data structure using a linked list, with a custom allocator.
+ *
+ * It behaves exactly as lds_new_list(), but the structure and its nodes are allocated and
+ * released through `allocator`.
+ *
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param allocator Allocator used for all the memory of the structure. If it is NULL, the
+ * standard malloc() and free() are used.
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*).
+ * @see LDS_ALLOCATOR
+ * @see lds_new_list
+ */
+LINEAR_DS* lds_new_list_ex(size_t data_size, const LDS_ALLOCATOR *allocator);
+
+/**
+ * @brief Creates a new vector whose first elements are stored inside the structure itself.
+ *
+ * The structure and room for `inline_capacity` elements are obtained in a single allocation, so
+ * a small vector costs one allocation and its elements are next to its fields. When the vector
+ * outgrows that room, its elements move to a separate array, transparently; they move back if the
+ * vector shrinks enough again (see lds_shrink_to_fit() and LDS_GROWTH_POLICY).
+ *
+ * @param inline_capacity Number of elements stored inside the structure; it is also the initial capacity.
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*).
+ * @note The function dynamically allocates memory for the linear data structure. It is the caller's
+ * responsibility to free this memory using lds_free() when it is no longer needed.
+ * @see lds_new_vector
+ */
+LINEAR_DS* lds_new_small_vector(size_t inline_capacity, size_t data_size);
+
+/**
+ * @brief Creates a new vector whose first elements are stored inside the structure, with a custom allocator.
+ *
+ * It behaves exactly as lds_new_small_vector(), but all the memory is allocated and released
+ * through `allocator`.
+ *
+ * @param inline_capacity Number of elements stored inside the structure; it is also the initial capacity.
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param allocator Allocator used for all the memory of the structure. If it is NULL, the
+ * standard malloc(), realloc() and free() are used.
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*).
+ * @see lds_new_small_vector
+ */
+LINEAR_DS* lds_new_small_vector_ex(size_t inline_capacity, size_t data_size, const LDS_ALLOCATOR *allocator);
+
+/**
+ * @brief Creates a new vector whose array of elements is aligned to a given boundary.
+ *
+ * The array starts at a multiple of `alignment` bytes, and keeps this alignment whenever it grows
+ * or shrinks (the elements are copied to a new aligned array instead of using realloc()). With
+ * `pad`, each element takes a multiple of `alignment` bytes, so that every element, not only the
+ * first slot of the array, is aligned, and no element crosses a boundary of that size (for
+ * example, a cache line or a SIMD register width).
+ *
+ * @code
+ * // Records of 40 bytes, each one starting at its own 64-byte cache line
+ * LINEAR_DS *particles = lds_new_vector_aligned(1024, sizeof(PARTICLE), 64, 1);
+ * @endcode
+ *
+ * @param initial_capacity Initial capacity of the array for storing elements.
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param alignment Alignment, in bytes, of the array; it must be a power of 2.
+ * @param pad If nonzero, the distance between consecutive elements is `data_size` rounded up to
+ * a multiple of `alignment`.
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*), or NULL if
+ * `alignment` is not a power of 2 or there is no memory available.
+ * @note Elements are still copied in and out with `data_size` bytes; the padding is never read or
+ * written. Since the vector is circular, contiguous elements may wrap around the end of the array.
+ * @see lds_new_vector
+ */
+LINEAR_DS* lds_new_vector_aligned(size_t initial_capacity, size_t data_size, size_t alignment, int pad);
+
+/**
+ * @brief Creates a new linear data structure using a doubly linked list.
+ *
+ * Each node also links to the previous one. Positional operations start walking from the first
+ * node, the last node or the current position of the iterator, whichever is closest, so accesses
+ * and removals near either end take constant time. The iterator can move backwards with
+ * lds_it_prev().
+ *
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*).
+ * @note The function dynamically allocates memory for the linear data structure. It is the caller's
+ * responsibility to free this memory using lds_free() when it is no longer needed.
+ * @see lds_it_prev
+ */
+LINEAR_DS* lds_new_dlist(size_t data_size);
+
+/**
+ * @brief Creates a new linear data structure using a doubly linked list, with a custom allocator.
+ *
+ * It behaves exactly as lds_new_dlist(), but the structure and its nodes are allocated and
+ * released through `allocator`.
+ *
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param allocator Allocator used for all the memory of the structure. If it is NULL, the
+ * standard malloc() and free() are used.
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*).
+ * @see LDS_ALLOCATOR
+ * @see lds_new_dlist
+ */
+LINEAR_DS* lds_new_dlist_ex(size_t data_size, const LDS_ALLOCATOR *allocator);
+
+/**
+ * @brief Creates a vector for real-time use, which never allocates memory after its creation.
+ *
+ * The structure and room for `capacity` elements are allocated in a single block, whose pages are
+ * touched right away so that later accesses do not page-fault. The capacity never changes: an
+ * insertion into a full vector, and any other operation that would need memory (lds_reserve(),
+ * lds_set_pow2_capacity(), etc.), returns LDS_FAIL instead of calling the allocator.
+ *
+ * @param capacity Maximum number of elements.
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param lock_memory If nonzero, the block is also locked in physical memory with mlock(), so it
+ * is never swapped out (supported only on Linux, subject to RLIMIT_MEMLOCK).
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*), or NULL if the
+ * memory could not be allocated or locked.
+ * @note Release it with lds_free().
+ * @see lds_allocation_free
+ */
+LINEAR_DS* lds_new_rt_vector(size_t capacity, size_t data_size, int lock_memory);
+
+/**
+ * @brief Creates a linked list for real-time use, which never allocates memory after its creation.
+ *
+ * The nodes come from a private reserve of `max_nodes` nodes, allocated and touched at once.
+ * When the reserve is exhausted, insertions return LDS_FAIL instead of calling the allocator;
+ * removed nodes return to the reserve.
+ *
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param max_nodes Maximum number of elements.
+ * @param lock_memory If nonzero, the structure and its reserve are also locked in physical
+ * memory with mlock() (supported only on Linux, subject to RLIMIT_MEMLOCK).
+ * @return A pointer to the newly created linear data structure (LINEAR_DS*), or NULL if the
+ * memory could not be allocated or locked.
+ * @note Release it with lds_free(), which also releases the reserve.
+ * @see lds_allocation_free
+ */
+LINEAR_DS* lds_new_rt_list(size_t data_size, size_t max_nodes, int lock_memory);
+
+/**
+ * @brief Initializes a vector in storage provided by the caller.
+ *
+ * It behaves as lds_new_vector_ex(), but the header of the structure is placed in `storage`
+ * instead of being allocated; only the array of elements is allocated.
+ *
+ * @param storage Storage for the header. It must remain valid until lds_destroy() is called.
+ * @param initial_capacity Initial capacity of the array for storing elements.
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param allocator Allocator used for the elements. If it is NULL, the standard malloc(),
+ * realloc() and free() are used.
+ * @return A pointer to the structure, which lies inside `storage`, or NULL on failure.
+ * @note Release it with lds_destroy() (lds_free() does the same for these structures).
+ * @see LDS_HANDLE_STORAGE
+ */
+LINEAR_DS* lds_init_vector(LDS_HANDLE_STORAGE *storage, size_t initial_capacity, size_t data_size,
+                           const LDS_ALLOCATOR *allocator);
+
+/**
+ * @brief Initializes a linked list in storage provided by the caller.
+ *
+ * It behaves as lds_new_list_ex(), but the header of the structure is placed in `storage`
+ * instead of being allocated; only the nodes are allocated.
+ *
+ * @param storage Storage for the header. It must remain valid until lds_destroy() is called.
+ * @param data_size Size in bytes of each element to be stored in the structure.
+ * @param allocator Allocator used for the nodes. If it is NULL, the standard malloc() and free()
+ * are used.
+ * @return A pointer to the structure, which lies inside `storage`, or NULL on failure.
+ * @note Release it with lds_destroy() (lds_free() does the same for these structures).
+ * @see LDS_HANDLE_STORAGE
+ */
+LINEAR_DS* lds_init_list(LDS_HANDLE_STORAGE *storage, size_t data_size, const LDS_ALLOCATOR *allocator);
+
+/**
+ * @brief Releases the elements of a structure, but not its header.
+ *
+ * It is the counterpart of lds_init_vector() and lds_init_list(). After the call, the storage of
+ * the header can be reused or discarded by the caller.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @note For structures created by lds_new_vector(), lds_new_list() and similar functions, the
+ * header would be left allocated; use lds_free() for them.
+ */
+void lds_destroy(LINEAR_DS *ds);
+
+/**
+ * @brief Creates many vectors whose headers are laid out in a single block.
+ *
+ * One allocation holds the `count` headers, one after the other; each vector then allocates its
+ * own array of elements. Vectors created together and used together share cache lines and cost
+ * one allocation instead of `count`.
+ *
+ * @param out Array that receives the `count` pointers to the vectors.
+ * @param count Number of vectors to create.
+ * @param initial_capacity Initial capacity of each vector.
+ * @param data_size Size in bytes of each element to be stored in the vectors.
+ * @return LDS_SUCCESS on success, LDS_NULL if `out` is NULL or LDS_FAIL if there is no memory
+ * available (nothing is left allocated).
+ * @note The vectors must not be released individually; the whole set is released with
+ * lds_free_batch().
+ * @see lds_free_batch
+ */
+lds_return_t lds_new_vector_batch(LINEAR_DS *out[], size_t count, size_t initial_capacity, size_t data_size);
+
+/**
+ * @brief Creates many linked lists whose headers are laid out in a single block.
+ *
+ * It is the linked list counterpart of lds_new_vector_batch().
+ *
+ * @param out Array that receives the `count` pointers to the lists.
+ * @param count Number of lists to create.
+ * @param data_size Size in bytes of each element to be stored in the lists.
+ * @return LDS_SUCCESS on success, LDS_NULL if `out` is NULL or LDS_FAIL if there is no memory
+ * available (nothing is left allocated).
+ * @see lds_free_batch
+ */
+lds_return_t lds_new_list_batch(LINEAR_DS *out[], size_t count, size_t data_size);
+
+/**
+ * @brief Frees a set of structures created by lds_new_vector_batch() or lds_new_list_batch().
+ *
+ * @param ds The array filled by the batch constructor, unchanged.
+ * @param count Number of structures, as given to the batch constructor.
+ */
+void lds_free_batch(LINEAR_DS *ds[], size_t count);
+
 /**
  * @brief Frees the memory allocated for a linear data structure.
  *
@@ -421,11 +829,140 @@ LINEAR_DS* lds_new_list(size_t data_size);
  *
  * @param ds Pointer to the linear data structure to be freed.
  * @note The caller is responsible for ensuring that the pointer `ds` is valid and was previously
- * allocated by a function like lds_new_vector() or lds_new_list().
+ * allocated by a function like lds_new_vector() or lds_new_list(). For structures whose header
+ * belongs to the caller (lds_init_vector(), lds_init_list()) or to a batch, only the elements are
+ * released, as in lds_destroy().
  */
 void lds_free(LINEAR_DS *ds);
 
 
+/* Funes de pool de ns */
+/**
+ * @brief Creates a new pool of linked list nodes.
+ *
+ * The pool obtains its nodes from the system allocator in chunks of `nodes_per_chunk` nodes
+ * and keeps released nodes in a free list, so that lists bound to it recycle nodes instead of
+ * calling malloc() and free() for every element. One pool can be shared by many lists, as long
+ * as all of them store elements of the same size.
+ *
+ * @param data_size Size in bytes of each element stored in the nodes of the pool.
+ * @param nodes_per_chunk Number of nodes allocated at once when the pool runs out of free nodes.
+ * @return A pointer to the newly created pool, or NULL if there is no memory available.
+ * @note The pool must outlive every list bound to it. Free it with lds_free_node_pool().
+ * @see lds_new_list_from_pool
+ */
+LDS_NODE_POOL * lds_new_node_pool(size_t data_size, size_t nodes_per_chunk);
+
+/**
+ * @brief Creates a new pool of linked list nodes, with a custom allocator.
+ *
+ * It behaves exactly as lds_new_node_pool(), but the pool, its chunks and the lists created from
+ * it are allocated and released through `allocator`.
+ *
+ * @param data_size Size in bytes of each element stored in the nodes of the pool.
+ * @param nodes_per_chunk Number of nodes allocated at once when the pool runs out of free nodes.
+ * @param allocator Allocator used for all the memory of the pool. If it is NULL, the
+ * standard malloc() and free() are used.
+ * @return A pointer to the newly created pool, or NULL if there is no memory available.
+ * @see LDS_ALLOCATOR
+ */
+LDS_NODE_POOL * lds_new_node_pool_ex(size_t data_size, size_t nodes_per_chunk, const LDS_ALLOCATOR *allocator);
+
+/**
+ * @brief Creates a new linear data structure using a linked list whose nodes come from a pool.
+ *
+ * It behaves exactly as a list created by lds_new_list(), but every node is taken from and
+ * returned to `pool`. The size of the elements is the one given to the pool. Pools serve
+ * singly linked lists only.
+ *
+ * @param pool Pointer to the node pool.
+ * @return A pointer to the newly created linear data structure, or NULL if `pool` is NULL or
+ * there is no memory available.
+ * @see lds_new_node_pool
+ */
+LINEAR_DS* lds_new_list_from_pool(LDS_NODE_POOL *pool);
+
+/**
+ * @brief Returns the largest number of nodes that were in use at the same time in the pool.
+ *
+ * @param pool Pointer to the node pool.
+ * @return The high-water mark of the pool, in nodes. Zero if pool is NULL.
+ */
+size_t lds_node_pool_high_water(LDS_NODE_POOL *pool);
+
+/**
+ * @brief Gives back to the system the chunks of the pool whose nodes are all free.
+ *
+ * It takes O(n log n) time for n free nodes and chunks, so it stays cheap for pools with many chunks.
+ * Afterwards, the free nodes are handed out in address order.
+ *
+ * @param pool Pointer to the node pool.
+ * @return The number of chunks released. Zero if pool is NULL.
+ */
+size_t lds_node_pool_trim(LDS_NODE_POOL *pool);
+
+/**
+ * @brief Frees a node pool and all the memory allocated by it.
+ *
+ * @param pool Pointer to the node pool.
+ * @note Every list bound to the pool must be freed before the pool.
+ */
+void lds_free_node_pool(LDS_NODE_POOL *pool);
+
+
+/* Funes de arena */
+/**
+ * @brief Creates a new arena.
+ *
+ * An arena hands out memory by bumping a pointer inside large chunks and never releases
+ * individual blocks. Structures created with the arena allocator do not pay for per-element
+ * frees, and all of them are released at once, in time proportional to the number of chunks,
+ * when the arena is freed or reset.
+ *
+ * @param chunk_size Size in bytes of each chunk requested from the system. Larger blocks get a
+ * chunk of their own.
+ * @return A pointer to the newly created arena, or NULL if there is no memory available.
+ * @see lds_arena_allocator
+ *
+ * @code
+ * LDS_ARENA * arena = lds_new_arena(64 * 1024);
+ * LINEAR_DS * pending = lds_new_list_ex(sizeof(int), lds_arena_allocator(arena));
+ * LINEAR_DS * ids = lds_new_vector_ex(16, sizeof(long), lds_arena_allocator(arena));
+ * // ... use the structures; calling lds_free() on them is optional ...
+ * lds_free_arena(arena); // releases pending, ids and all of their elements
+ * @endcode
+ */
+LDS_ARENA * lds_new_arena(size_t chunk_size);
+
+/**
+ * @brief Returns the allocator that creates structures inside the arena.
+ *
+ * The allocator can be passed to lds_new_vector_ex(), lds_new_list_ex() and
+ * lds_new_node_pool_ex(). Its free function does nothing, so lds_free() on a list of the arena
+ * does not walk its nodes.
+ *
+ * @param arena Pointer to the arena.
+ * @return The allocator of the arena. NULL if arena is NULL.
+ */
+const LDS_ALLOCATOR * lds_arena_allocator(LDS_ARENA *arena);
+
+/**
+ * @brief Releases every structure created inside the arena, keeping one chunk for reuse.
+ *
+ * @param arena Pointer to the arena.
+ * @note Structures created inside the arena must not be used after it is reset.
+ */
+void lds_arena_reset(LDS_ARENA *arena);
+
+/**
+ * @brief Frees the arena and every structure created inside it.
+ *
+ * @param arena Pointer to the arena.
+ * @note Structures created inside the arena must not be used after it is freed.
+ */
+void lds_free_arena(LDS_ARENA *arena);
+
+
 /* Funes principais de manipulao */
 /**
  * @brief Inserts a value into the linear data structure at the specified position.
@@ -452,6 +989,49 @@ lds_return_t lds_insert(LINEAR_DS *ds, size_t position, void *value);
  */
 lds_return_t lds_insert_last(LINEAR_DS *ds, void *value);
 
+/**
+ * @brief Makes room for a new element at the specified position and returns its address.
+ *
+ * The structure grows by one element, as in lds_insert(), but nothing is copied into the new
+ * element: the caller builds it directly in the memory of the structure, without staging it in a
+ * separate variable.
+ *
+ * @code
+ * RECORD *r = lds_emplace(queue, lds_size(queue));
+ * if (r != NULL) {
+ *     r->id = id;
+ *     read_payload(r->payload);
+ * }
+ * @endcode
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param position Position of the new element (from 0 to the current size).
+ * @return Pointer to the new element, whose contents are undefined, or NULL if `ds` is NULL,
+ * `position` is out of range or there is no memory available.
+ * @note The new element must be fully written before any other operation on the structure, and
+ * the pointer is valid only until the next insertion or removal.
+ * @see lds_insert
+ */
+void * lds_emplace(LINEAR_DS *ds, size_t position);
+
+/**
+ * @brief Inserts several consecutive elements at the specified position.
+ *
+ * Equivalent to inserting `src[0]`, `src[1]`, ..., `src[count - 1]` at `position`, `position + 1`,
+ * and so on, but checked and dispatched once. A vector grows at most once and moves its elements
+ * once; a list finds the position once and links all the new nodes in a single step.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param position Position of the first new element (from 0 to the current size).
+ * @param src Array of `count` elements, each `data_size` bytes long.
+ * @param count Number of elements to insert.
+ * @return LDS_SUCCESS on success, LDS_NULL if `ds` or `src` is NULL, LDS_POS_ERR if `position` is
+ * out of range, or LDS_FAIL if there is no memory available, in which case the structure is left
+ * unchanged.
+ * @see lds_insert
+ */
+lds_return_t lds_insert_range(LINEAR_DS *ds, size_t position, const void *src, size_t count);
+
 /**
  * @brief Retrieves the value at the specified position in the linear data structure.
  *
@@ -465,6 +1045,50 @@ lds_return_t lds_insert_last(LINEAR_DS *ds, void *value);
  */
 lds_return_t lds_get(LINEAR_DS *ds, size_t position, void *element);
 
+/**
+ * @brief Copies several consecutive elements, starting at the specified position, into an array.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param position Position of the first element to copy.
+ * @param dst Array with room for `count` elements, each `data_size` bytes long.
+ * @param count Number of elements to copy.
+ * @return LDS_SUCCESS on success, LDS_NULL if `ds` or `dst` is NULL, or LDS_POS_ERR if the range
+ * `[position, position + count)` is not inside the structure.
+ * @see lds_get
+ */
+lds_return_t lds_get_range(LINEAR_DS *ds, size_t position, void *dst, size_t count);
+
+/**
+ * @brief Returns the address of the element at the specified position, without copying it.
+ *
+ * The pointer refers to the element stored inside the structure (the vector slot or the list
+ * node), so reading a field of a large element does not copy the whole element. Writing through
+ * the pointer changes the element in place.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param position Position of the element.
+ * @return Pointer to the element, or NULL if `ds` is NULL or `position` is out of range.
+ * @note The pointer is aligned for any type of `data_size` bytes (up to the alignment of
+ * max_align_t), in vectors and lists alike, so it can be cast to the type of the elements.
+ * @note The pointer is valid only until the next insertion or removal in the structure (or any
+ * other operation that may change its capacity), since elements of a vector may move.
+ * @see lds_front_ref
+ * @see lds_it_ref
+ */
+void * lds_get_ref(LINEAR_DS *ds, size_t position);
+
+/**
+ * @brief Returns the address of the first element, without copying it.
+ *
+ * It is the zero-copy counterpart of lds_queue_front() and lds_stack_peek().
+ *
+ * @param ds Pointer to the linear data structure.
+ * @return Pointer to the first element, or NULL if `ds` is NULL or the structure is empty.
+ * @note The pointer is valid only until the next insertion or removal in the structure.
+ * @see lds_get_ref
+ */
+void * lds_front_ref(LINEAR_DS *ds);
+
 /**
  * @brief Retrieves the last value from the linear data structure.
  *
@@ -490,6 +1114,21 @@ lds_return_t lds_get_last(LINEAR_DS *ds, void *element);
  */
 lds_return_t lds_set(LINEAR_DS *ds, size_t position, void *value);
 
+/**
+ * @brief Sets the value at the specified position, without comparing it to the current value.
+ *
+ * lds_set() compares the new value to the current one and returns LDS_FAIL if they are equal;
+ * this function always copies the value, saving one read of the element.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param position Position where the value should be set.
+ * @param value Pointer to the value to be set.
+ * @return LDS_SUCCESS on success, LDS_NULL if `ds` or `value` is NULL, or LDS_POS_ERR if
+ * `position` is out of range.
+ * @see lds_set
+ */
+lds_return_t lds_set_nocmp(LINEAR_DS *ds, size_t position, void *value);
+
 /**
  * @brief Removes the value at the specified position from the linear data structure.
  *
@@ -517,6 +1156,137 @@ lds_return_t lds_remove(LINEAR_DS *ds, size_t position, void *removed_element);
  */
 lds_return_t lds_remove_last(LINEAR_DS *ds, void *removed_element);
 
+/**
+ * @brief Removes several consecutive elements, starting at the specified position.
+ *
+ * Equivalent to calling lds_remove() `count` times at `position`, but a vector closes the gap with
+ * a single move of the shorter side, and a list finds the position once and unlinks the following
+ * nodes in sequence. Dropping the oldest `n` entries of a vector used as a queue costs O(n).
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param position Position of the first element to remove.
+ * @param count Number of elements to remove.
+ * @param removed Array with room for `count` elements that receives the removed elements in
+ * order, or NULL to discard them.
+ * @return LDS_SUCCESS on success, LDS_NULL if `ds` is NULL, or LDS_POS_ERR if the range
+ * `[position, position + count)` is not inside the structure.
+ * @see lds_remove
+ */
+lds_return_t lds_remove_range(LINEAR_DS *ds, size_t position, size_t count, void *removed);
+
+/**
+ * @brief Removes all elements from the linear data structure.
+ *
+ * A vector is emptied in constant time and keeps its capacity; use lds_shrink_to_fit() to return
+ * the memory. A list releases all its nodes; nodes taken from a pool go back to it in one step.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @return LDS_SUCCESS on success, or LDS_NULL if `ds` is NULL.
+ */
+lds_return_t lds_clear(LINEAR_DS *ds);
+
+/**
+ * @brief Moves a range of elements from one linear data structure to another.
+ *
+ * The elements `[from, from + count)` of `src` are removed from it and inserted, in the same
+ * order, at `position` in `dst`.
+ *
+ * When both are lists of the same kind whose nodes come from the same place (the same node pool,
+ * or the same allocator when there is no pool), the nodes themselves are relinked: nothing is
+ * allocated, freed or copied, and moving a whole list costs constant time. Otherwise the elements
+ * are copied with the bulk operations used by lds_insert_range() and lds_remove_range().
+ *
+ * @code
+ * // Moves the first n tasks of the ready list to the end of the wait list.
+ * lds_splice(wait, lds_size(wait), ready, 0, n);
+ * @endcode
+ *
+ * @param dst Structure that receives the elements.
+ * @param position Position in `dst` of the first moved element (from 0 to the size of `dst`).
+ * @param src Structure that loses the elements; must be different from `dst`.
+ * @param from Position in `src` of the first element to move.
+ * @param count Number of elements to move.
+ * @return LDS_SUCCESS on success, LDS_NULL if `dst` or `src` is NULL, LDS_POS_ERR if a position
+ * is out of range, or LDS_FAIL if `dst` and `src` are the same structure, have different element
+ * sizes, or there is no memory available for a copy, in which case both are left unchanged.
+ * @see lds_concat, lds_split
+ */
+lds_return_t lds_splice(LINEAR_DS *dst, size_t position, LINEAR_DS *src, size_t from, size_t count);
+
+/**
+ * @brief Moves all elements of `src` to the end of `dst`, leaving `src` empty.
+ *
+ * Same as `lds_splice(dst, lds_size(dst), src, 0, lds_size(src))`; compatible lists are joined in
+ * constant time.
+ *
+ * @param dst Structure that receives the elements.
+ * @param src Structure that loses the elements; it is not freed.
+ * @return The same values as lds_splice().
+ * @see lds_splice
+ */
+lds_return_t lds_concat(LINEAR_DS *dst, LINEAR_DS *src);
+
+/**
+ * @brief Splits the linear data structure in two at the specified position.
+ *
+ * The elements from `position` to the end are moved to a new structure of the same type, and
+ * `ds` keeps the elements before `position`. A new list shares the allocator and node pool of
+ * `ds`, so its nodes are moved without copying; a new vector has the same element layout, growth
+ * policy and options as `ds`.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param position Position of the first element of the new structure (from 0 to the current size).
+ * @return Pointer to the new structure, which must be freed with lds_free(), or NULL if `ds` is
+ * NULL, `position` is out of range, `ds` is a real-time structure, or there is no memory available.
+ * @note A list sharing a node pool must be freed before the pool.
+ * @see lds_splice
+ */
+LINEAR_DS* lds_split(LINEAR_DS *ds, size_t position);
+
+/**
+ * @brief Creates a read-only view of a range of a linear data structure, without copying it.
+ *
+ * The view is a LINEAR_DS whose elements are the elements `[position, position + count)` of `ds`,
+ * read directly from the memory of `ds`. It supports every read function: lds_size(), lds_get(),
+ * lds_get_range(), lds_get_ref(), iterators, cursors and lds_it_next_span(). Functions that would
+ * change it (insertions, removals, lds_set(), lds_clear(), lds_splice(), ...) fail with LDS_FAIL
+ * or NULL. For a vector, creating a view takes constant time; for a list, it takes one walk to the
+ * range.
+ *
+ * @code
+ * LINEAR_DS *batch = lds_view(samples, 1000, 1000);
+ * process(batch);            // reads elements 1000..1999 of samples
+ * lds_free(batch);           // frees only the view
+ * @endcode
+ *
+ * @param ds Pointer to the linear data structure (it can also be a view).
+ * @param position Position in `ds` of the first element of the view.
+ * @param count Number of elements in the view.
+ * @return Pointer to the view, which must be freed with lds_free(), or NULL if `ds` is NULL, the
+ * range is not inside `ds`, or there is no memory available.
+ * @note Any insertion or removal in `ds`, or freeing it, invalidates the view; it may then only be
+ * freed. Values changed in `ds` with lds_set() are seen through the view. lds_capacity() of a view
+ * is meaningless.
+ * @note The view header is obtained from the allocator of `ds`, except for real-time structures
+ * with locked memory (lds_new_rt_vector(), lds_new_rt_list()), whose views and copies use malloc()
+ * so that they do not take locked pages.
+ * @see lds_view_materialize
+ */
+LINEAR_DS* lds_view(LINEAR_DS *ds, size_t position, size_t count);
+
+/**
+ * @brief Copies the elements of a view into a new, independent linear data structure.
+ *
+ * The copy has the type, element layout and options of the structure the view refers to, and can
+ * be changed and kept after that structure changes or is freed.
+ *
+ * @param view Pointer to a view (any linear data structure is accepted, and copied).
+ * @return Pointer to the new structure, which must be freed with lds_free(), or NULL if `view` is
+ * NULL or there is no memory available.
+ * @see lds_view
+ */
+LINEAR_DS* lds_view_materialize(LINEAR_DS *view);
+
 
 /* Funes para consultar os campos da estrutura */
 /**
@@ -580,6 +1350,111 @@ size_t lds_data_size(LINEAR_DS *ds);
  */
 lds_type_t lds_type(LINEAR_DS *ds);
 
+/**
+ * @brief Returns the size, in bytes, of the header of a linear data structure.
+ *
+ * The header holds the fields of the structure and its embedded iterator. Elements of vectors
+ * and nodes of lists are not included, except that small vectors (lds_new_small_vector()) also
+ * hold their inline elements in the same block.
+ *
+ * @return Size in bytes of the LINEAR_DS header.
+ */
+size_t lds_sizeof_handle(void);
+
+/**
+ * @brief Tells whether operations on the structure are guaranteed not to allocate memory.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @return LDS_SUCCESS if no operation, except lds_free(), calls the allocator (structures created
+ * by lds_new_rt_vector() and lds_new_rt_list()), LDS_FAIL otherwise, or LDS_NULL if `ds` is NULL.
+ * @note A view (lds_view()) is not a real-time structure, even of one: LDS_FAIL.
+ */
+lds_return_t lds_allocation_free(LINEAR_DS *ds);
+
+/**
+ * @brief Makes a vector grow incrementally, bounding the cost of each insertion.
+ *
+ * When the vector is full and an element is inserted at either end, the new array is allocated
+ * but the elements are not copied at once: a few of them migrate on each following operation at
+ * the ends (insertion, removal), while accesses read from whichever array holds the element.
+ * Thus no single lds_enqueue(), lds_insert_last() or lds_stack_push() copies the whole vector.
+ * Any other operation that needs the whole vector in one array (insertion or removal in the
+ * middle, lds_reserve(), lds_shrink_to_fit(), etc.) first completes the migration.
+ *
+ * While the migration is in progress, both arrays are allocated, along with a small record of
+ * the migration; the handle itself does not grow.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @return LDS_SUCCESS on success, LDS_NULL if `ds` is NULL, or LDS_FAIL if it is not a vector.
+ * @note Small vectors (lds_new_small_vector()) leaving their inline storage grow at once.
+ */
+lds_return_t lds_set_incremental_growth(LINEAR_DS *ds);
+
+/**
+ * @brief Stores the elements of a large vector in an anonymous memory mapping.
+ *
+ * Whenever the array of elements has at least `bytes` bytes, it is obtained with mmap() instead
+ * of the allocator of the vector, and it grows with mremap(), which moves page tables instead of
+ * copying the elements. If `huge_pages` is nonzero, the mapping is aligned to 2 MiB and advised
+ * to use transparent huge pages (madvise(MADV_HUGEPAGE)), reducing TLB misses on random accesses.
+ * The current array is moved right away if the new threshold changes where it belongs.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param bytes Minimum size, in bytes, of a mapped array; zero disables mappings.
+ * @param huge_pages Nonzero to request transparent huge pages for the mappings.
+ * @return LDS_SUCCESS on success, LDS_NULL if `ds` is NULL, or LDS_FAIL if it is not a vector,
+ * there is no memory available or the platform does not support mappings (only Linux does).
+ * @note Mapped arrays take whole pages, so use thresholds of at least a few pages.
+ */
+lds_return_t lds_set_mmap_threshold(LINEAR_DS *ds, size_t bytes, int huge_pages);
+
+/**
+ * @brief Makes a vector keep its capacity as a power of two.
+ *
+ * The current capacity is rounded up to the next power of two, and every later growth keeps it
+ * that way. Positions in the circular array are then wrapped with a bit mask instead of an
+ * integer division, which makes every access cheaper.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @return LDS_SUCCESS, LDS_NULL if ds is NULL, or LDS_FAIL if the structure is not a vector or
+ * there is no memory to round up its capacity.
+ * @see lds_capacity
+ */
+lds_return_t lds_set_pow2_capacity(LINEAR_DS *ds);
+
+/**
+ * @brief Makes sure a vector can hold at least `capacity` elements without reallocation.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param capacity Minimum capacity desired.
+ * @return LDS_SUCCESS, LDS_NULL if ds is NULL, or LDS_FAIL if there is no memory available.
+ * Linked lists have no capacity, so the call has no effect on them.
+ * @see lds_capacity
+ */
+lds_return_t lds_reserve(LINEAR_DS *ds, size_t capacity);
+
+/**
+ * @brief Reduces the capacity of a vector to its number of elements.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @return LDS_SUCCESS, LDS_NULL if ds is NULL, or LDS_FAIL if there is no memory available to
+ * move the elements. Linked lists have no capacity, so the call has no effect on them.
+ * @note The capacity never goes below one element, and it is rounded up to a power of two when
+ * lds_set_pow2_capacity() was called.
+ */
+lds_return_t lds_shrink_to_fit(LINEAR_DS *ds);
+
+/**
+ * @brief Sets how a vector grows and when it gives memory back.
+ *
+ * @param ds Pointer to the linear data structure.
+ * @param policy Pointer to the policy, or NULL to restore the default behavior (capacity doubles
+ * when the vector is full and never shrinks).
+ * @return LDS_SUCCESS, LDS_NULL if ds is NULL, or LDS_FAIL if the structure is not a vector.
+ * @see LDS_GROWTH_POLICY
+ */
+lds_return_t lds_set_growth_policy(LINEAR_DS *ds, const LDS_GROWTH_POLICY *policy);
+
 
 
 /* Funes de iterador */
@@ -587,12 +1462,39 @@ lds_type_t lds_type(LINEAR_DS *ds);
  * @brief Returns an iterator for traversing the elements of the linear data structure.
  *
  * This function returns an iterator that allows sequential access to the elements of the linear data structure.
+ * Positional functions such as lds_get() and lds_insert() do not move it, and the same rules hold for
+ * vectors and lists:
+ * - after an insertion or a removal elsewhere, it keeps referring to the same element, whose position
+ *   may change; if that element is removed, it moves to the first element after the removed ones;
+ * - if it is past the last element and elements are inserted at the end, it moves to the first new
+ *   element, so a consumer of a queue sees the elements enqueued after it caught up;
+ * - lds_it_add() and lds_it_remove() on it keep its position, which then holds the new element or
+ *   the element after the removed one.
  *
  * @param ds Pointer to the linear data structure.
  * @return An iterator (LDS_ITERATOR*) for the linear data structure.
+ * @see lds_cursor_init
  */
 LDS_ITERATOR * lds_iterator(LINEAR_DS *ds);
 
+/**
+ * @brief Initializes a cursor, an additional iterator in storage owned by the caller.
+ *
+ * The cursor starts at position 0 and is used with the lds_it_* functions, like the iterator
+ * returned by lds_iterator(). Nothing is allocated and nothing needs to be released.
+ *
+ * @param cursor Storage for the cursor. It must remain valid while the cursor is used.
+ * @param ds Pointer to the linear data structure to traverse.
+ * @return The cursor as an iterator, or NULL if `cursor` or `ds` is NULL.
+ * @note Reading, and writing element values, never affects other cursors. On lists, an insertion or
+ * removal made other than through the cursor itself invalidates it; move it with lds_it_reset() or
+ * lds_it_go() before using it again. On vectors, a cursor is just a position and always stays
+ * usable: if removals leave it past the last element, the lds_it_* functions that read, write,
+ * insert, remove or advance return LDS_POS_ERR until it is moved.
+ * @see LDS_CURSOR
+ */
+LDS_ITERATOR * lds_cursor_init(LDS_CURSOR *cursor, LINEAR_DS *ds);
+
 /**
  * @brief Returns the current position of the iterator.
  *
@@ -626,6 +1528,18 @@ lds_return_t lds_it_add(LDS_ITERATOR *it, void *value);
  */
 lds_return_t lds_it_next(LDS_ITERATOR *it);
 
+/**
+ * @brief Moves the iterator to the previous position in the linear data structure.
+ *
+ * This function moves the iterator one position back. It takes constant time on vectors and
+ * doubly linked lists; on singly linked lists it walks again from the first element.
+ *
+ * @param it Pointer to the iterator.
+ * @return lds_return_t indicating the result of the operation (LDS_SUCCESS or an error code).
+ * LDS_POS_ERR if the iterator is already at the first position.
+ */
+lds_return_t lds_it_prev(LDS_ITERATOR *it);
+
 /**
  * @brief Checks if there is a next element in the linear data structure.
  *
@@ -647,6 +1561,47 @@ lds_return_t lds_it_has_next(LDS_ITERATOR *it);
  */
 lds_return_t lds_it_get(LDS_ITERATOR *it, void *element);
 
+/**
+ * @brief Returns the address of the element at the current position of the iterator, without copying it.
+ *
+ * @param it Pointer to the iterator.
+ * @return Pointer to the element, or NULL if `it` is NULL or the iterator is past the last element.
+ * @note The pointer is valid only until the next insertion or removal in the structure.
+ * @see lds_get_ref
+ */
+void * lds_it_ref(LDS_ITERATOR *it);
+
+/**
+ * @brief Returns the run of elements that are contiguous in memory from the position of the
+ * iterator, and moves the iterator past them.
+ *
+ * A loop over the runs touches the elements where they are stored, without a call and a copy per
+ * element. A vector has at most two runs (its storage is circular); each node of a list is a run
+ * of one element.
+ *
+ * @code
+ * LDS_CURSOR c;
+ * LDS_ITERATOR *it = lds_cursor_init(&c, samples);
+ * double *x, sum = 0;
+ * size_t n, i;
+ * while ((n = lds_it_next_span(it, (void**)&x)) > 0) {
+ *     for (i = 0; i < n; i++) {
+ *         sum += x[i];
+ *     }
+ * }
+ * @endcode
+ *
+ * @param it Pointer to the iterator.
+ * @param data Receives the address of the first element of the run, or NULL at the end.
+ * @return Number of elements in the run, or 0 if the iterator is past the last element or an
+ * argument is NULL.
+ * @note Consecutive elements of a run are `data_size` bytes apart, except in a padded vector from
+ * lds_new_vector_aligned(), where they are `data_size` rounded up to the alignment apart. The
+ * pointer is valid only until the next insertion or removal in the structure.
+ * @see lds_it_ref
+ */
+size_t lds_it_next_span(LDS_ITERATOR *it, void **data);
+
 /**
  * @brief Sets the value of the element at the current position of the iterator.
  *
@@ -0,0 +1,1387 @@
+/*
+ * Verificaes de comportamento da biblioteca, sem interao com o usurio.
+ * Cada funo verifica um grupo de operaes. O programa termina com cdigo
+ * diferente de zero se alguma verificao falhar (usado pelo ctest).
+ */
+#include <iostream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include "../src/lineards.h"
+
+using namespace std;
+
+static int falhas = 0;
+
+#define VERIFICAR(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+            falhas++; \
+        } \
+    } while (0)
+
+/* Compara todos os elementos da estrutura com os do vector. */
+static bool mesmo_conteudo(LINEAR_DS * lds, const vector<int> & vec) {
+    if (lds_size(lds) != vec.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < vec.size(); i++) {
+        int value;
+        if (lds_get(lds, i, &value) != LDS_SUCCESS || value != vec[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_node_pool() {
+    LDS_NODE_POOL *pool = lds_new_node_pool(sizeof(int), 4);
+    VERIFICAR(pool != NULL);
+    LINEAR_DS *a = lds_new_list_from_pool(pool);
+    LINEAR_DS *b = lds_new_list_from_pool(pool);
+    VERIFICAR(a != NULL && b != NULL);
+    VERIFICAR(lds_data_size(a) == sizeof(int));
+    VERIFICAR(lds_new_list_from_pool(NULL) == NULL);
+
+    // Duas listas dividem o mesmo pool.
+    vector<int> va, vb;
+    for (int i = 0; i < 10; i++) {
+        lds_insert(a, i / 2, &i);
+        va.insert(va.begin() + i / 2, i);
+        int j = 100 + i;
+        lds_enqueue(b, &j);
+        vb.push_back(j);
+    }
+    VERIFICAR(mesmo_conteudo(a, va));
+    VERIFICAR(mesmo_conteudo(b, vb));
+    VERIFICAR(lds_node_pool_high_water(pool) == 20);
+
+    // Ns devolvidos ao pool so reaproveitados.
+    for (int i = 0; i < 10; i++) {
+        lds_dequeue(b, NULL);
+    }
+    VERIFICAR(lds_size(b) == 0);
+    for (int i = 0; i < 10; i++) {
+        lds_stack_push(b, &i);
+    }
+    VERIFICAR(lds_node_pool_high_water(pool) == 20);
+
+    // S os blocos totalmente livres voltam ao sistema; os ns de b ficam.
+    lds_free(a);
+    lds_node_pool_trim(pool);
+    int top;
+    VERIFICAR(lds_stack_peek(b, &top) == LDS_SUCCESS && top == 9);
+    VERIFICAR(lds_size(b) == 10);
+    lds_free(b);
+    VERIFICAR(lds_node_pool_trim(pool) > 0);
+    VERIFICAR(lds_node_pool_trim(pool) == 0);
+    VERIFICAR(lds_node_pool_high_water(NULL) == 0);
+    VERIFICAR(lds_node_pool_trim(NULL) == 0);
+    lds_free_node_pool(pool);
+
+    // Muitos blocos: cada um com um n de cada lista; s a liberao das duas os esvazia.
+    pool = lds_new_node_pool(sizeof(int), 2);
+    a = lds_new_list_from_pool(pool);
+    b = lds_new_list_from_pool(pool);
+    for (int i = 0; i < 20000; i++) {
+        lds_enqueue(a, &i);
+        lds_enqueue(b, &i);
+    }
+    lds_clear(a);
+    VERIFICAR(lds_node_pool_trim(pool) == 0);
+    for (int i = 0; i < 100; i++) {
+        lds_stack_push(a, &i);
+    }
+    // Os ns livres saem por endereo: um em cada um dos 100 primeiros blocos.
+    lds_free(b);
+    VERIFICAR(lds_node_pool_trim(pool) == 20000 - 100);
+    VERIFICAR(lds_size(a) == 100);
+    lds_free(a);
+    VERIFICAR(lds_node_pool_trim(pool) == 100);
+    lds_free_node_pool(pool);
+}
+
+/* Alocador que confere se cada bloco  liberado com o tamanho com que foi obtido. */
+struct Contabilidade {
+    map<void*, size_t> blocos;
+    size_t erros;
+};
+
+static void * conta_alloc(void *context, size_t size) {
+    Contabilidade *c = (Contabilidade*)context;
+    void *ptr = malloc(size);
+    if (ptr != NULL) {
+        c->blocos[ptr] = size;
+    }
+    return ptr;
+}
+
+static void * conta_realloc(void *context, void *ptr, size_t old_size, size_t new_size) {
+    Contabilidade *c = (Contabilidade*)context;
+    if (c->blocos.count(ptr) == 0 || c->blocos[ptr] != old_size) {
+        c->erros++;
+    }
+    void *new_ptr = realloc(ptr, new_size);
+    if (new_ptr != NULL) {
+        c->blocos.erase(ptr);
+        c->blocos[new_ptr] = new_size;
+    }
+    return new_ptr;
+}
+
+static void conta_free(void *context, void *ptr, size_t size) {
+    Contabilidade *c = (Contabilidade*)context;
+    if (c->blocos.count(ptr) == 0 || c->blocos[ptr] != size) {
+        c->erros++;
+    }
+    c->blocos.erase(ptr);
+    free(ptr);
+}
+
+void check_allocator() {
+    for (int com_realloc = 0; com_realloc < 2; com_realloc++) {
+        Contabilidade c;
+        c.erros = 0;
+        LDS_ALLOCATOR allocator = { conta_alloc, com_realloc ? conta_realloc : NULL, conta_free, &c };
+
+        LINEAR_DS *lds[5];
+        lds[0] = lds_new_vector_ex(2, sizeof(int), &allocator);
+        lds[1] = lds_new_list_ex(sizeof(int), &allocator);
+        lds[2] = lds_new_dlist_ex(sizeof(int), &allocator);
+        lds[3] = lds_new_small_vector_ex(4, sizeof(int), &allocator);
+        LDS_NODE_POOL *pool = lds_new_node_pool_ex(sizeof(int), 8, &allocator);
+        lds[4] = lds_new_list_from_pool(pool);
+
+        for (int k = 0; k < 5; k++) {
+            VERIFICAR(lds[k] != NULL);
+            vector<int> vec;
+            for (int i = 0; i < 200; i++) {
+                size_t position = (size_t)(i * 7) % (vec.size() + 1);
+                lds_insert(lds[k], position, &i);
+                vec.insert(vec.begin() + position, i);
+                if (i % 3 == 0) {
+                    lds_remove(lds[k], 0, NULL);
+                    vec.erase(vec.begin());
+                }
+            }
+            VERIFICAR(mesmo_conteudo(lds[k], vec));
+        }
+        VERIFICAR(!c.blocos.empty());
+
+        for (int k = 0; k < 5; k++) {
+            lds_free(lds[k]);
+        }
+        lds_free_node_pool(pool);
+        VERIFICAR(c.blocos.empty());
+        VERIFICAR(c.erros == 0);
+    }
+}
+
+void check_arena() {
+    VERIFICAR(lds_arena_allocator(NULL) == NULL);
+    LDS_ARENA *arena = lds_new_arena(1024);
+    VERIFICAR(arena != NULL);
+
+    for (int round = 0; round < 3; round++) {
+        LINEAR_DS *list = lds_new_list_ex(sizeof(int), lds_arena_allocator(arena));
+        LINEAR_DS *vec_lds = lds_new_vector_ex(4, sizeof(long), lds_arena_allocator(arena));
+        VERIFICAR(list != NULL && vec_lds != NULL);
+        vector<int> vec;
+        for (int i = 0; i < 500; i++) {
+            lds_insert(list, (size_t)i % (vec.size() + 1), &i);
+            vec.insert(vec.begin() + (size_t)i % (vec.size() + 1), i);
+            long l = i;
+            lds_enqueue(vec_lds, &l);
+        }
+        VERIFICAR(mesmo_conteudo(list, vec));
+        long last;
+        VERIFICAR(lds_get(vec_lds, 499, &last) == LDS_SUCCESS && last == 499);
+
+        // lds_free()  opcional; sem ele, o reset libera tudo de uma vez.
+        if (round == 0) {
+            lds_free(list);
+            lds_free(vec_lds);
+        }
+        lds_arena_reset(arena);
+    }
+
+    // Ns de um pool da arena
+    LDS_NODE_POOL *pool = lds_new_node_pool_ex(sizeof(int), 16, lds_arena_allocator(arena));
+    LINEAR_DS *list = lds_new_list_from_pool(pool);
+    for (int i = 0; i < 100; i++) {
+        lds_stack_push(list, &i);
+    }
+    int top;
+    VERIFICAR(lds_stack_pop(list, &top) == LDS_SUCCESS && top == 99);
+    lds_free_arena(arena);
+}
+
+/* Mistura operaes de fila e pilha com operaes por posio. */
+static void misturar_fila(LINEAR_DS *lds, vector<int> & vec, int operations) {
+    for (int i = 0; i < operations; i++) {
+        int value = rand() % 1000, out = -1;
+        switch (rand() % 7) {
+            case 0:
+                VERIFICAR(lds_enqueue(lds, &value) == LDS_SUCCESS);
+                vec.push_back(value);
+                break;
+            case 1:
+                VERIFICAR(lds_stack_push(lds, &value) == LDS_SUCCESS);
+                vec.insert(vec.begin(), value);
+                break;
+            case 2:
+                if (vec.empty()) {
+                    VERIFICAR(lds_dequeue(lds, &out) != LDS_SUCCESS);
+                    break;
+                }
+                VERIFICAR(lds_dequeue(lds, &out) == LDS_SUCCESS && out == vec.front());
+                vec.erase(vec.begin());
+                break;
+            case 3:
+                if (vec.empty()) {
+                    VERIFICAR(lds_remove_last(lds, &out) != LDS_SUCCESS);
+                    break;
+                }
+                VERIFICAR(lds_remove_last(lds, &out) == LDS_SUCCESS && out == vec.back());
+                vec.pop_back();
+                break;
+            case 4: {
+                size_t position = (size_t)rand() % (vec.size() + 1);
+                VERIFICAR(lds_insert(lds, position, &value) == LDS_SUCCESS);
+                vec.insert(vec.begin() + position, value);
+                break;
+            }
+            case 5:
+                if (!vec.empty()) {
+                    size_t position = (size_t)rand() % vec.size();
+                    VERIFICAR(lds_remove(lds, position, &out) == LDS_SUCCESS && out == vec[position]);
+                    vec.erase(vec.begin() + position);
+                }
+                break;
+            default:
+                VERIFICAR(lds_insert_last(lds, &value) == LDS_SUCCESS);
+                vec.push_back(value);
+                break;
+        }
+        if (!vec.empty()) {
+            VERIFICAR(lds_queue_front(lds, &out) == LDS_SUCCESS && out == vec.front());
+            VERIFICAR(lds_stack_peek(lds, &out) == LDS_SUCCESS && out == vec.front());
+            VERIFICAR(lds_get(lds, vec.size() - 1, &out) == LDS_SUCCESS && out == vec.back());
+        }
+    }
+}
+
+void check_list_queue() {
+    srand(5);
+    LINEAR_DS *lists[2] = { lds_new_list(sizeof(int)), lds_new_dlist(sizeof(int)) };
+    for (int k = 0; k < 2; k++) {
+        vector<int> vec;
+        misturar_fila(lists[k], vec, 3000);
+        VERIFICAR(mesmo_conteudo(lists[k], vec));
+
+        // Esvazia e volta a usar: first e last precisam ser refeitos.
+        while (!vec.empty()) {
+            lds_dequeue(lists[k], NULL);
+            vec.erase(vec.begin());
+        }
+        VERIFICAR(lds_empty(lists[k]));
+        misturar_fila(lists[k], vec, 500);
+        VERIFICAR(mesmo_conteudo(lists[k], vec));
+        lds_free(lists[k]);
+    }
+}
+
+/* Percorre a estrutura do fim para o incio com o iterador. */
+static bool mesmo_conteudo_ao_contrario(LINEAR_DS * lds, const vector<int> & vec) {
+    if (vec.empty()) {
+        return lds_size(lds) == 0;
+    }
+    LDS_ITERATOR *it = lds_iterator(lds);
+    if (lds_it_go(it, vec.size() - 1) != LDS_SUCCESS) {
+        return false;
+    }
+    for (size_t i = vec.size(); i > 0; i--) {
+        int value;
+        if (lds_it_position(it) != i - 1 || lds_it_get(it, &value) != LDS_SUCCESS || value != vec[i - 1]) {
+            return false;
+        }
+        if (i > 1 && lds_it_prev(it) != LDS_SUCCESS) {
+            return false;
+        }
+    }
+    return lds_it_prev(it) == LDS_POS_ERR;
+}
+
+void check_dlist() {
+    srand(6);
+    LINEAR_DS *lds = lds_new_dlist(sizeof(int));
+    VERIFICAR(lds != NULL && lds_type(lds) == LDS_DOUBLY_LINKED_LIST);
+    vector<int> vec;
+    for (int round = 0; round < 20; round++) {
+        misturar_fila(lds, vec, 200);
+        VERIFICAR(mesmo_conteudo(lds, vec));
+        VERIFICAR(mesmo_conteudo_ao_contrario(lds, vec));
+    }
+
+    // Posies perto do fim so alcanadas a partir do ltimo n.
+    LDS_ITERATOR *it = lds_iterator(lds);
+    for (size_t i = 0; i < vec.size(); i += vec.size() / 7 + 1) {
+        int value;
+        size_t position = vec.size() - 1 - i;
+        VERIFICAR(lds_it_go(it, position) == LDS_SUCCESS);
+        VERIFICAR(lds_it_get(it, &value) == LDS_SUCCESS && value == vec[position]);
+        VERIFICAR(lds_it_go(it, i) == LDS_SUCCESS);
+        VERIFICAR(lds_it_get(it, &value) == LDS_SUCCESS && value == vec[i]);
+    }
+
+    // Insero e remoo pelo iterador mantm os dois encadeamentos.
+    lds_it_go(it, vec.size() / 2);
+    int value = -1;
+    VERIFICAR(lds_it_add(it, &value) == LDS_SUCCESS);
+    vec.insert(vec.begin() + vec.size() / 2, value);
+    lds_it_go(it, 1);
+    VERIFICAR(lds_it_remove(it, NULL) == LDS_SUCCESS);
+    vec.erase(vec.begin() + 1);
+    VERIFICAR(mesmo_conteudo_ao_contrario(lds, vec));
+    lds_free(lds);
+}
+
+static bool potencia_de_2(size_t n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+void check_pow2() {
+    srand(7);
+    LINEAR_DS *lds = lds_new_vector(10, sizeof(int));
+    VERIFICAR(lds_set_pow2_capacity(lds) == LDS_SUCCESS);
+    VERIFICAR(lds_capacity(lds) == 16);
+    vector<int> vec;
+    for (int round = 0; round < 30; round++) {
+        misturar_fila(lds, vec, 100);
+        VERIFICAR(potencia_de_2(lds_capacity(lds)));
+        VERIFICAR(mesmo_conteudo(lds, vec));
+    }
+    VERIFICAR(lds_reserve(lds, 1000) == LDS_SUCCESS && lds_capacity(lds) == 1024);
+    VERIFICAR(lds_shrink_to_fit(lds) == LDS_SUCCESS && potencia_de_2(lds_capacity(lds)));
+    VERIFICAR(lds_capacity(lds) >= vec.size() && lds_capacity(lds) < 2 * vec.size() + 1);
+    VERIFICAR(mesmo_conteudo(lds, vec));
+    lds_free(lds);
+
+    LINEAR_DS *list = lds_new_list(sizeof(int));
+    VERIFICAR(lds_set_pow2_capacity(list) == LDS_FAIL);
+    VERIFICAR(lds_set_pow2_capacity(NULL) == LDS_NULL);
+    lds_free(list);
+}
+
+void check_ring_shift() {
+    // Para cada rotao do anel, tamanho e posio, insere e remove no meio.
+    for (int pow2 = 0; pow2 < 2; pow2++) {
+        for (int rotation = 0; rotation < 8; rotation++) {
+            for (int size = 0; size < 8; size++) {
+                for (int position = 0; position <= size; position++) {
+                    LINEAR_DS *lds = lds_new_vector(8, sizeof(int));
+                    if (pow2) {
+                        lds_set_pow2_capacity(lds);
+                    }
+                    for (int i = 0; i < rotation; i++) {
+                        lds_enqueue(lds, &i);
+                        lds_dequeue(lds, NULL);
+                    }
+                    vector<int> vec;
+                    for (int i = 0; i < size; i++) {
+                        lds_enqueue(lds, &i);
+                        vec.push_back(i);
+                    }
+                    int value = 100;
+                    VERIFICAR(lds_insert(lds, position, &value) == LDS_SUCCESS);
+                    vec.insert(vec.begin() + position, value);
+                    VERIFICAR(lds_capacity(lds) == 8);
+                    VERIFICAR(mesmo_conteudo(lds, vec));
+
+                    int removed;
+                    VERIFICAR(lds_remove(lds, position, &removed) == LDS_SUCCESS && removed == value);
+                    vec.erase(vec.begin() + position);
+                    if (size > 0) {
+                        size_t other = (size_t)(size - 1 - position / 2);
+                        VERIFICAR(lds_remove(lds, other, &removed) == LDS_SUCCESS && removed == vec[other]);
+                        vec.erase(vec.begin() + other);
+                    }
+                    VERIFICAR(mesmo_conteudo(lds, vec));
+                    lds_free(lds);
+                }
+            }
+        }
+    }
+}
+
+void check_capacity() {
+    LINEAR_DS *lds = lds_new_vector(4, sizeof(int));
+    vector<int> vec;
+    for (int i = 0; i < 3; i++) {
+        lds_enqueue(lds, &i);
+        vec.push_back(i);
+    }
+    VERIFICAR(lds_reserve(lds, 100) == LDS_SUCCESS && lds_capacity(lds) == 100);
+    VERIFICAR(lds_reserve(lds, 10) == LDS_SUCCESS && lds_capacity(lds) == 100);
+    VERIFICAR(lds_shrink_to_fit(lds) == LDS_SUCCESS && lds_capacity(lds) == 3);
+    VERIFICAR(mesmo_conteudo(lds, vec));
+
+    // Cresce 1,5 vez, mas no mximo 10 elementos por vez.
+    static const LDS_GROWTH_POLICY limited = { 1.5, 10, 0, 0 };
+    VERIFICAR(lds_set_growth_policy(lds, &limited) == LDS_SUCCESS);
+    int value = 3;
+    lds_enqueue(lds, &value);
+    vec.push_back(value);
+    VERIFICAR(lds_capacity(lds) == 4);
+    for (value = 4; value < 40; value++) {
+        size_t before = lds_capacity(lds);
+        lds_enqueue(lds, &value);
+        vec.push_back(value);
+        VERIFICAR(lds_capacity(lds) == before || lds_capacity(lds) <= before + 10);
+    }
+    VERIFICAR(mesmo_conteudo(lds, vec));
+
+    // Abaixo de 1/4 da capacidade, devolve memria, mas no abaixo de min_capacity.
+    static const LDS_GROWTH_POLICY shrinking = { 2.0, 0, 0.25, 8 };
+    VERIFICAR(lds_set_growth_policy(lds, &shrinking) == LDS_SUCCESS);
+    VERIFICAR(lds_reserve(lds, 400) == LDS_SUCCESS);
+    while (vec.size() > 1) {
+        lds_dequeue(lds, NULL);
+        vec.erase(vec.begin());
+        VERIFICAR(lds_capacity(lds) >= 8);
+    }
+    VERIFICAR(lds_capacity(lds) < 400);
+    VERIFICAR(mesmo_conteudo(lds, vec));
+
+    // Sem poltica, volta a dobrar e nunca diminuir.
+    VERIFICAR(lds_set_growth_policy(lds, NULL) == LDS_SUCCESS);
+    VERIFICAR(lds_shrink_to_fit(lds) == LDS_SUCCESS && lds_capacity(lds) == 1);
+    value = 1;
+    lds_enqueue(lds, &value);
+    VERIFICAR(lds_capacity(lds) == 2);
+    lds_dequeue(lds, NULL);
+    lds_dequeue(lds, NULL);
+    VERIFICAR(lds_shrink_to_fit(lds) == LDS_SUCCESS && lds_capacity(lds) == 1);
+    lds_free(lds);
+
+    LINEAR_DS *list = lds_new_list(sizeof(int));
+    VERIFICAR(lds_reserve(list, 100) == LDS_SUCCESS);
+    VERIFICAR(lds_shrink_to_fit(list) == LDS_SUCCESS);
+    VERIFICAR(lds_set_growth_policy(list, &limited) == LDS_FAIL);
+    VERIFICAR(lds_reserve(NULL, 1) == LDS_NULL && lds_shrink_to_fit(NULL) == LDS_NULL);
+    lds_free(list);
+}
+
+void check_small_vector() {
+    Contabilidade c;
+    c.erros = 0;
+    LDS_ALLOCATOR allocator = { conta_alloc, conta_realloc, conta_free, &c };
+    LINEAR_DS *lds = lds_new_small_vector_ex(8, sizeof(int), &allocator);
+    VERIFICAR(lds != NULL && lds_capacity(lds) == 8);
+    VERIFICAR(c.blocos.size() == 1);
+
+    // At 8 elementos, tudo fica no bloco da prpria estrutura.
+    vector<int> vec;
+    for (int i = 0; i < 8; i++) {
+        lds_insert(lds, (size_t)i / 2, &i);
+        vec.insert(vec.begin() + i / 2, i);
+    }
+    VERIFICAR(c.blocos.size() == 1);
+    VERIFICAR(mesmo_conteudo(lds, vec));
+
+    // Ao crescer, os elementos vo para um vetor separado...
+    for (int i = 8; i < 20; i++) {
+        lds_enqueue(lds, &i);
+        vec.push_back(i);
+    }
+    VERIFICAR(c.blocos.size() == 2);
+    VERIFICAR(lds_capacity(lds) >= 20);
+    VERIFICAR(mesmo_conteudo(lds, vec));
+
+    // ... e voltam para dentro dela quando cabem de novo.
+    while (vec.size() > 5) {
+        lds_dequeue(lds, NULL);
+        vec.erase(vec.begin());
+    }
+    VERIFICAR(lds_shrink_to_fit(lds) == LDS_SUCCESS);
+    VERIFICAR(c.blocos.size() == 1 && lds_capacity(lds) == 8);
+    VERIFICAR(mesmo_conteudo(lds, vec));
+    lds_free(lds);
+    VERIFICAR(c.blocos.empty() && c.erros == 0);
+
+    // Com o alocador padro, o comportamento  o mesmo.
+    lds = lds_new_small_vector(4, sizeof(int));
+    VERIFICAR(lds != NULL && lds_capacity(lds) == 4);
+    for (int i = 0; i < 10; i++) {
+        lds_stack_push(lds, &i);
+    }
+    int top;
+    VERIFICAR(lds_size(lds) == 10 && lds_stack_peek(lds, &top) == LDS_SUCCESS && top == 9);
+    lds_free(lds);
+}
+
+void check_ops_tables() {
+    VERIFICAR(lds_sizeof_handle() <= LDS_HANDLE_SIZE);
+
+    // Instncias do mesmo tipo dividem a tabela de operaes, mas no o estado.
+    LINEAR_DS *lds[6] = {
+        lds_new_vector(2, sizeof(int)), lds_new_vector(2, sizeof(int)),
+        lds_new_list(sizeof(int)), lds_new_list(sizeof(int)),
+        lds_new_dlist(sizeof(int)), lds_new_dlist(sizeof(int))
+    };
+    vector<int> vec[6];
+    for (int i = 0; i < 60; i++) {
+        for (int k = 0; k < 6; k++) {
+            int value = i * 10 + k;
+            if (k % 2 == 0) {
+                lds_insert(lds[k], vec[k].size() / 2, &value);
+                vec[k].insert(vec[k].begin() + vec[k].size() / 2, value);
+            }
+            else {
+                LDS_ITERATOR *it = lds_iterator(lds[k]);
+                lds_it_reset(it);
+                lds_it_add(it, &value);
+                vec[k].insert(vec[k].begin(), value);
+            }
+        }
+    }
+    for (int k = 0; k < 6; k++) {
+        VERIFICAR(mesmo_conteudo(lds[k], vec[k]));
+        VERIFICAR(lds_type(lds[k]) == (k < 2 ? LDS_VECTOR : k < 4 ? LDS_LINKED_LIST : LDS_DOUBLY_LINKED_LIST));
+        lds_free(lds[k]);
+    }
+}
+
+/* Estrutura do usurio com a fila embutida. */
+struct Sessao {
+    int id;
+    LDS_HANDLE_STORAGE queue_storage;
+    LINEAR_DS *queue;
+};
+
+void check_caller_owned() {
+    Contabilidade c;
+    c.erros = 0;
+    LDS_ALLOCATOR allocator = { conta_alloc, conta_realloc, conta_free, &c };
+
+    Sessao sessions[2];
+    sessions[0].queue = lds_init_vector(&sessions[0].queue_storage, 2, sizeof(int), &allocator);
+    sessions[1].queue = lds_init_list(&sessions[1].queue_storage, sizeof(int), &allocator);
+    VERIFICAR(lds_init_vector(NULL, 2, sizeof(int), NULL) == NULL);
+    VERIFICAR(lds_init_list(NULL, sizeof(int), NULL) == NULL);
+    for (int k = 0; k < 2; k++) {
+        Sessao *session = &sessions[k];
+        session->id = k;
+        VERIFICAR((void*)session->queue == (void*)&session->queue_storage);
+        vector<int> vec;
+        for (int i = 0; i < 50; i++) {
+            lds_enqueue(session->queue, &i);
+            vec.push_back(i);
+        }
+        VERIFICAR(mesmo_conteudo(session->queue, vec));
+        lds_destroy(session->queue);
+    }
+    // O cabealho no passa pelo alocador; os elementos sim, e todos voltam.
+    VERIFICAR(c.blocos.empty() && c.erros == 0);
+
+    // Cabealhos em lote
+    LINEAR_DS *vectors[5], *lists[5];
+    VERIFICAR(lds_new_vector_batch(vectors, 5, 4, sizeof(int)) == LDS_SUCCESS);
+    VERIFICAR(lds_new_list_batch(lists, 5, sizeof(int)) == LDS_SUCCESS);
+    VERIFICAR(lds_new_vector_batch(NULL, 5, 4, sizeof(int)) == LDS_NULL);
+    for (int i = 0; i < 100; i++) {
+        lds_enqueue(vectors[i % 5], &i);
+        lds_stack_push(lists[i % 5], &i);
+    }
+    for (int k = 0; k < 5; k++) {
+        int first, top;
+        VERIFICAR(lds_size(vectors[k]) == 20 && lds_size(lists[k]) == 20);
+        VERIFICAR(lds_queue_front(vectors[k], &first) == LDS_SUCCESS && first == k);
+        VERIFICAR(lds_stack_peek(lists[k], &top) == LDS_SUCCESS && top == 95 + k);
+    }
+    lds_free_batch(vectors, 5);
+    lds_free_batch(lists, 5);
+}
+
+void check_incremental() {
+    Contabilidade c;
+    c.erros = 0;
+    LDS_ALLOCATOR allocator = { conta_alloc, conta_realloc, conta_free, &c };
+    LINEAR_DS *lds = lds_new_vector_ex(4, sizeof(int), &allocator);
+    VERIFICAR(lds_set_incremental_growth(lds) == LDS_SUCCESS);
+    VERIFICAR(lds_set_incremental_growth(NULL) == LDS_NULL);
+    LINEAR_DS *list = lds_new_list(sizeof(int));
+    VERIFICAR(lds_set_incremental_growth(list) == LDS_FAIL);
+    lds_free(list);
+
+    // Cresce vrias vezes, com operaes nas duas pontas durante as migraes.
+    vector<int> vec;
+    srand(13);
+    misturar_fila(lds, vec, 3000);
+
+    // Vises criadas no meio de uma migrao leem dos dois vetores.
+    while (lds_size(lds) < lds_capacity(lds)) {
+        int i = (int)lds_size(lds);
+        lds_enqueue(lds, &i);
+        vec.push_back(i);
+    }
+    int extra = -1;
+    lds_enqueue(lds, &extra);
+    vec.push_back(extra);
+    LINEAR_DS *view = lds_view(lds, 1, vec.size() - 1);
+    VERIFICAR(mesmo_conteudo(view, vector<int>(vec.begin() + 1, vec.end())));
+    LINEAR_DS *copy = lds_view_materialize(view);
+    VERIFICAR(mesmo_conteudo(copy, vector<int>(vec.begin() + 1, vec.end())));
+    lds_free(copy);
+    lds_free(view);
+
+    // Uma operao no meio termina a migrao.
+    lds_insert(lds, 1, &extra);
+    vec.insert(vec.begin() + 1, extra);
+    VERIFICAR(mesmo_conteudo(lds, vec));
+
+    // O estado da migrao fica fora do cabealho e volta ao alocador no fim.
+    VERIFICAR(lds_sizeof_handle() <= 25 * sizeof(void*));
+    lds_free(lds);
+    VERIFICAR(c.blocos.empty() && c.erros == 0);
+}
+
+void check_mmap() {
+    Contabilidade c;
+    c.erros = 0;
+    LDS_ALLOCATOR allocator = { conta_alloc, conta_realloc, conta_free, &c };
+    for (int huge_pages = 0; huge_pages < 2; huge_pages++) {
+        LINEAR_DS *lds = lds_new_vector_ex(4, sizeof(int), &allocator);
+        VERIFICAR(lds_set_mmap_threshold(lds, 16384, huge_pages) == LDS_SUCCESS);
+        vector<int> vec;
+        for (int i = 0; i < 20000; i++) {
+            lds_enqueue(lds, &i);
+            vec.push_back(i);
+        }
+        // O vetor grande est mapeado: s o cabealho vem do alocador.
+        VERIFICAR(mesmo_conteudo(lds, vec));
+        VERIFICAR(c.blocos.size() == 1);
+
+        // Encolher abaixo do limite traz o vetor de volta ao alocador.
+        while (vec.size() > 100) {
+            lds_dequeue(lds, NULL);
+            vec.erase(vec.begin());
+        }
+        VERIFICAR(lds_shrink_to_fit(lds) == LDS_SUCCESS);
+        VERIFICAR(mesmo_conteudo(lds, vec));
+        VERIFICAR(c.blocos.size() == 2);
+
+        // Desligar os mapeamentos com o vetor mapeado tambm o traz de volta.
+        for (int i = 0; i < 20000; i++) {
+            lds_stack_push(lds, &i);
+            vec.insert(vec.begin(), i);
+        }
+        VERIFICAR(lds_set_mmap_threshold(lds, 0, 0) == LDS_SUCCESS);
+        VERIFICAR(mesmo_conteudo(lds, vec));
+        VERIFICAR(c.blocos.size() == 2);
+        lds_free(lds);
+    }
+    VERIFICAR(c.blocos.empty() && c.erros == 0);
+
+    // Com pginas grandes, os vetores continuam alinhados a 2 MiB depois de cada
+    // crescimento. Vrios crescendo juntos impedem que cresam sempre no lugar.
+    LINEAR_DS *huge[4];
+    size_t capacity[4];
+    for (int k = 0; k < 4; k++) {
+        huge[k] = lds_new_vector(4, sizeof(int));
+        VERIFICAR(lds_set_mmap_threshold(huge[k], 16384, 1) == LDS_SUCCESS);
+        capacity[k] = 0;
+    }
+    bool aligned = true;
+    for (int i = 0; i < (1 << 21); i++) {
+        for (int k = 0; k < 4; k++) {
+            lds_enqueue(huge[k], &i);
+            if (lds_capacity(huge[k]) != capacity[k]) {
+                capacity[k] = lds_capacity(huge[k]);
+                if (capacity[k] * sizeof(int) >= 16384) {
+                    aligned = aligned && (uintptr_t)lds_get_ref(huge[k], 0) % (2 * 1024 * 1024) == 0;
+                }
+            }
+        }
+    }
+    VERIFICAR(aligned);
+    for (int k = 0; k < 4; k++) {
+        lds_free(huge[k]);
+    }
+
+    LINEAR_DS *list = lds_new_list(sizeof(int));
+    VERIFICAR(lds_set_mmap_threshold(list, 16384, 0) == LDS_FAIL);
+    VERIFICAR(lds_set_mmap_threshold(NULL, 16384, 0) == LDS_NULL);
+    lds_free(list);
+}
+
+void check_rt() {
+    LINEAR_DS *rt[2];
+    rt[0] = lds_new_rt_vector(8, sizeof(int), 0);
+    rt[1] = lds_new_rt_list(sizeof(int), 8, 0);
+    for (int k = 0; k < 2; k++) {
+        LINEAR_DS *lds = rt[k];
+        VERIFICAR(lds != NULL);
+        VERIFICAR(lds_allocation_free(lds) == LDS_SUCCESS);
+
+        // Cheia, a estrutura recusa inseres em vez de alocar.
+        vector<int> vec;
+        for (int i = 0; i < 8; i++) {
+            VERIFICAR(lds_enqueue(lds, &i) == LDS_SUCCESS);
+            vec.push_back(i);
+        }
+        int extra = 99;
+        VERIFICAR(lds_enqueue(lds, &extra) == LDS_FAIL);
+        VERIFICAR(lds_insert(lds, 3, &extra) == LDS_FAIL);
+        VERIFICAR(mesmo_conteudo(lds, vec));
+
+        // Espao liberado por remoes volta a ser usado.
+        for (int round = 0; round < 20; round++) {
+            int front;
+            VERIFICAR(lds_dequeue(lds, &front) == LDS_SUCCESS && front == vec.front());
+            vec.erase(vec.begin());
+            VERIFICAR(lds_insert(lds, 2, &round) == LDS_SUCCESS);
+            vec.insert(vec.begin() + 2, round);
+        }
+        VERIFICAR(mesmo_conteudo(lds, vec));
+        lds_free(lds);
+    }
+    // Nem as operaes que s mudam a capacidade alocam.
+    LINEAR_DS *fixed = lds_new_rt_vector(6, sizeof(int), 0);
+    VERIFICAR(lds_reserve(fixed, 16) == LDS_FAIL);
+    VERIFICAR(lds_set_pow2_capacity(fixed) == LDS_FAIL);
+    lds_free(fixed);
+
+    LINEAR_DS *vector_lds = lds_new_vector(8, sizeof(int));
+    VERIFICAR(lds_allocation_free(vector_lds) == LDS_FAIL);
+    VERIFICAR(lds_allocation_free(NULL) == LDS_NULL);
+    lds_free(vector_lds);
+}
+
+/* Preenche um elemento de size bytes a partir de um nmero. */
+static void preencher(unsigned char *element, size_t size, int value) {
+    for (size_t b = 0; b < size; b++) {
+        element[b] = (unsigned char)(value * 31 + b);
+    }
+}
+
+void check_element_sizes() {
+    const size_t sizes[] = { 1, 2, 4, 8, 16, 3, 12, 24 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t size = sizes[s];
+        LINEAR_DS *lds[3];
+        lds[0] = lds_new_vector(2, size);
+        lds[1] = lds_new_list(size);
+        lds[2] = lds_new_dlist(size);
+        for (int k = 0; k < 3; k++) {
+            // Cada elemento do modelo  guardado como size bytes seguidos.
+            vector<unsigned char> model;
+            unsigned char element[24], read[24];
+            for (int i = 0; i < 40; i++) {
+                preencher(element, size, i);
+                size_t position = (size_t)(i * 5) % (model.size() / size + 1);
+                VERIFICAR(lds_insert(lds[k], position, element) == LDS_SUCCESS);
+                model.insert(model.begin() + position * size, element, element + size);
+                if (i % 4 == 3) {
+                    position = (size_t)i % (model.size() / size);
+                    VERIFICAR(lds_remove(lds[k], position, read) == LDS_SUCCESS);
+                    VERIFICAR(equal(read, read + size, model.begin() + position * size));
+                    model.erase(model.begin() + position * size, model.begin() + (position + 1) * size);
+                }
+            }
+            preencher(element, size, 1000);
+            VERIFICAR(lds_set(lds[k], 7, element) == LDS_SUCCESS);
+            copy(element, element + size, model.begin() + 7 * size);
+
+            bool same = lds_size(lds[k]) * size == model.size();
+            for (size_t i = 0; same && i < lds_size(lds[k]); i++) {
+                same = lds_get(lds[k], i, read) == LDS_SUCCESS &&
+                       equal(read, read + size, model.begin() + i * size);
+            }
+            VERIFICAR(same);
+            lds_free(lds[k]);
+        }
+    }
+}
+
+void check_aligned() {
+    VERIFICAR(lds_new_vector_aligned(4, 40, 48, 1) == NULL);
+
+    // Com pad, todo elemento comea numa linha de 64 bytes, mesmo aps crescer.
+    LINEAR_DS *lds = lds_new_vector_aligned(2, 40, 64, 1);
+    unsigned char element[40], read[40];
+    for (int i = 0; i < 100; i++) {
+        preencher(element, sizeof(element), i);
+        lds_stack_push(lds, element);
+    }
+    bool aligned = true, same = true;
+    for (size_t i = 0; i < lds_size(lds); i++) {
+        aligned = aligned && (uintptr_t)lds_get_ref(lds, i) % 64 == 0;
+        preencher(element, sizeof(element), 99 - (int)i);
+        same = same && lds_get(lds, i, read) == LDS_SUCCESS && equal(read, read + 40, element);
+    }
+    VERIFICAR(aligned && same);
+    VERIFICAR(lds_shrink_to_fit(lds) == LDS_SUCCESS);
+    VERIFICAR((uintptr_t)lds_get_ref(lds, 1) % 64 == 0);
+    lds_free(lds);
+
+    // Sem pad, s o incio do vetor fica alinhado.
+    lds = lds_new_vector_aligned(8, sizeof(int), 4096, 0);
+    for (int i = 0; i < 1000; i++) {
+        lds_enqueue(lds, &i);
+    }
+    VERIFICAR((uintptr_t)lds_get_ref(lds, 0) % 4096 == 0);
+    VERIFICAR((char*)lds_get_ref(lds, 1) - (char*)lds_get_ref(lds, 0) == sizeof(int));
+    lds_free(lds);
+}
+
+void check_node_alignment() {
+    LDS_NODE_POOL *pool = lds_new_node_pool(sizeof(long double), 5);
+    LINEAR_DS *lds[4];
+    lds[0] = lds_new_list(sizeof(long double));
+    lds[1] = lds_new_dlist(sizeof(long double));
+    lds[2] = lds_new_list_from_pool(pool);
+    lds[3] = lds_new_rt_list(sizeof(long double), 16, 0);
+    for (int k = 0; k < 4; k++) {
+        for (int i = 0; i < 12; i++) {
+            long double *value = (long double*)lds_emplace(lds[k], lds_size(lds[k]) / 2);
+            VERIFICAR(value != NULL && (uintptr_t)value % alignof(long double) == 0);
+            *value = i / 3.0L;
+        }
+        bool aligned = true;
+        for (size_t i = 0; i < lds_size(lds[k]); i++) {
+            aligned = aligned && (uintptr_t)lds_get_ref(lds[k], i) % alignof(long double) == 0;
+        }
+        LDS_ITERATOR *it = lds_iterator(lds[k]);
+        for (lds_it_reset(it); lds_it_has_next(it) == LDS_SUCCESS; lds_it_next(it)) {
+            aligned = aligned && (uintptr_t)lds_it_ref(it) % alignof(long double) == 0;
+        }
+        VERIFICAR(aligned);
+        VERIFICAR(lds_front_ref(lds[k]) == lds_get_ref(lds[k], 0));
+        lds_free(lds[k]);
+    }
+    lds_free_node_pool(pool);
+    VERIFICAR(lds_front_ref(NULL) == NULL);
+
+    // Elementos de tamanho mpar no pagam espao extra, mas continuam corretos.
+    LINEAR_DS *list = lds_new_list(3);
+    unsigned char element[3] = { 1, 2, 3 }, read[3];
+    lds_enqueue(list, element);
+    VERIFICAR(lds_get(list, 0, read) == LDS_SUCCESS && equal(read, read + 3, element));
+    lds_free(list);
+}
+
+void check_emplace() {
+    LINEAR_DS *lds[3];
+    lds[0] = lds_new_vector(2, sizeof(int));
+    lds[1] = lds_new_list(sizeof(int));
+    lds[2] = lds_new_dlist(sizeof(int));
+    for (int k = 0; k < 3; k++) {
+        vector<int> vec;
+        for (int i = 0; i < 30; i++) {
+            size_t position = (size_t)(i * 7) % (vec.size() + 1);
+            int *slot = (int*)lds_emplace(lds[k], position);
+            VERIFICAR(slot != NULL);
+            *slot = i;
+            vec.insert(vec.begin() + position, i);
+        }
+        VERIFICAR(mesmo_conteudo(lds[k], vec));
+        VERIFICAR(lds_emplace(lds[k], vec.size() + 1) == NULL);
+        VERIFICAR(lds_emplace(NULL, 0) == NULL);
+
+        // lds_set() recusa o valor igual ao atual; lds_set_nocmp() sempre grava.
+        int same = vec[4], other = 1000;
+        VERIFICAR(lds_set(lds[k], 4, &same) == LDS_FAIL);
+        VERIFICAR(lds_set_nocmp(lds[k], 4, &same) == LDS_SUCCESS);
+        VERIFICAR(lds_set_nocmp(lds[k], 5, &other) == LDS_SUCCESS);
+        vec[5] = other;
+        VERIFICAR(lds_set_nocmp(lds[k], vec.size(), &other) == LDS_POS_ERR);
+        VERIFICAR(lds_set_nocmp(lds[k], 0, NULL) == LDS_NULL);
+        VERIFICAR(mesmo_conteudo(lds[k], vec));
+        lds_free(lds[k]);
+    }
+}
+
+void check_ranges() {
+    LINEAR_DS *lds[3];
+    lds[0] = lds_new_vector(4, sizeof(int));
+    lds[1] = lds_new_list(sizeof(int));
+    lds[2] = lds_new_dlist(sizeof(int));
+    for (int k = 0; k < 3; k++) {
+        vector<int> vec;
+        // Gira o vetor circular para que os intervalos passem pelo fim do buffer.
+        for (int i = 0; i < 3; i++) {
+            lds_enqueue(lds[k], &i);
+            lds_dequeue(lds[k], NULL);
+        }
+        for (int round = 0; round < 20; round++) {
+            int src[7];
+            for (int i = 0; i < 7; i++) {
+                src[i] = round * 10 + i;
+            }
+            size_t count = (size_t)round % 8;
+            size_t position = (size_t)(round * 5) % (vec.size() + 1);
+            VERIFICAR(lds_insert_range(lds[k], position, src, count) == LDS_SUCCESS);
+            vec.insert(vec.begin() + position, src, src + count);
+            VERIFICAR(mesmo_conteudo(lds[k], vec));
+
+            int dst[7];
+            count = min(vec.size() - position, (size_t)7);
+            VERIFICAR(lds_get_range(lds[k], position, dst, count) == LDS_SUCCESS);
+            VERIFICAR(equal(dst, dst + count, vec.begin() + position));
+            if (round % 3 == 2) {
+                count = min(vec.size() - position, (size_t)4);
+                VERIFICAR(lds_remove_range(lds[k], position, count, dst) == LDS_SUCCESS);
+                VERIFICAR(equal(dst, dst + count, vec.begin() + position));
+                vec.erase(vec.begin() + position, vec.begin() + position + count);
+            }
+        }
+        VERIFICAR(mesmo_conteudo(lds[k], vec));
+
+        int dst[2];
+        VERIFICAR(lds_insert_range(lds[k], vec.size() + 1, dst, 1) == LDS_POS_ERR);
+        VERIFICAR(lds_insert_range(lds[k], 0, NULL, 1) == LDS_NULL);
+        VERIFICAR(lds_get_range(lds[k], vec.size() - 1, dst, 2) == LDS_POS_ERR);
+        VERIFICAR(lds_get_range(lds[k], 0, NULL, 1) == LDS_NULL);
+        VERIFICAR(mesmo_conteudo(lds[k], vec));
+
+        // Esvaziar mantm a capacidade do vetor, e a estrutura continua usvel.
+        size_t capacity = lds_capacity(lds[k]);
+        VERIFICAR(lds_clear(lds[k]) == LDS_SUCCESS);
+        VERIFICAR(lds_size(lds[k]) == 0 && lds_it_position(lds_iterator(lds[k])) == 0);
+        VERIFICAR(k != 0 || lds_capacity(lds[k]) == capacity);
+        vec.assign(3, 7);
+        VERIFICAR(lds_insert_range(lds[k], 0, vec.data(), 3) == LDS_SUCCESS);
+        VERIFICAR(mesmo_conteudo(lds[k], vec));
+        lds_free(lds[k]);
+    }
+    VERIFICAR(lds_clear(NULL) == LDS_NULL);
+
+    // Os ns de uma lista esvaziada voltam ao pool.
+    LDS_NODE_POOL *pool = lds_new_node_pool(sizeof(int), 8);
+    LINEAR_DS *list = lds_new_list_from_pool(pool);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 20; i++) {
+            lds_enqueue(list, &i);
+        }
+        VERIFICAR(lds_clear(list) == LDS_SUCCESS && lds_size(list) == 0);
+    }
+    VERIFICAR(lds_node_pool_high_water(pool) == 20);
+    lds_free(list);
+    lds_free_node_pool(pool);
+}
+
+void check_iterator_follows() {
+    LINEAR_DS *lds[4];
+    lds[0] = lds_new_vector(2, sizeof(int));
+    lds[1] = lds_new_vector(2, sizeof(int));
+    lds_set_incremental_growth(lds[1]);
+    lds[2] = lds_new_list(sizeof(int));
+    lds[3] = lds_new_dlist(sizeof(int));
+    for (int k = 0; k < 4; k++) {
+        srand(21);
+        vector<int> vec;
+        size_t it_position = 0;
+        LDS_ITERATOR *it = lds_iterator(lds[k]);
+        bool follows = true;
+        for (int i = 0; i < 2000 && follows; i++) {
+            int values[3] = { i, i + 1, i + 2 };
+            size_t size = vec.size();
+            size_t position = (size_t)rand() % (size + 1);
+            size_t count = 1;
+            bool insert = true;
+            switch (rand() % 8) {
+                case 0: lds_insert(lds[k], position, values); break;
+                case 1: lds_enqueue(lds[k], values); position = size; break;
+                case 2: lds_stack_push(lds[k], values); position = 0; break;
+                case 3: count = 3; lds_insert_range(lds[k], position, values, count); break;
+                case 4: *(int*)lds_emplace(lds[k], position) = values[0]; break;
+                case 5:
+                    insert = false;
+                    count = min(size - min(position, size), (size_t)2);
+                    lds_remove_range(lds[k], position, count, NULL);
+                    break;
+                case 6:
+                    insert = false;
+                    count = size > 0 ? 1 : 0;
+                    position = 0;
+                    lds_dequeue(lds[k], NULL);
+                    break;
+                default:
+                    it_position = (size_t)rand() % (size + 1);
+                    lds_it_go(it, it_position);
+                    continue;
+            }
+            // A mesma regra para todos os tipos: o iterador segue o seu elemento.
+            if (insert) {
+                vec.insert(vec.begin() + position, values, values + count);
+                if (it_position >= position && !(it_position == position && position == size)) {
+                    it_position += count;
+                }
+            }
+            else {
+                vec.erase(vec.begin() + position, vec.begin() + position + count);
+                if (it_position >= position + count) {
+                    it_position -= count;
+                }
+                else if (it_position > position) {
+                    it_position = position;
+                }
+            }
+            int value;
+            follows = lds_it_position(it) == it_position &&
+                      (it_position == vec.size() || (lds_it_get(it, &value) == LDS_SUCCESS && value == vec[it_position]));
+        }
+        VERIFICAR(follows);
+        VERIFICAR(mesmo_conteudo(lds[k], vec));
+        lds_free(lds[k]);
+    }
+}
+
+void check_splice() {
+    // Entre estruturas de todos os tipos: ns religados ou elementos copiados.
+    LINEAR_DS *lds[3];
+    for (int a = 0; a < 3; a++) {
+        for (int b = 0; b < 3; b++) {
+            for (int k = 0; k < 2; k++) {
+                int kind = k == 0 ? a : b;
+                lds[k] = kind == 0 ? lds_new_vector(2, sizeof(int)) :
+                         kind == 1 ? lds_new_list(sizeof(int)) : lds_new_dlist(sizeof(int));
+            }
+            vector<int> va, vb;
+            for (int i = 0; i < 20; i++) {
+                int j = 100 + i;
+                lds_enqueue(lds[0], &i);
+                va.push_back(i);
+                lds_enqueue(lds[1], &j);
+                vb.push_back(j);
+            }
+            VERIFICAR(lds_splice(lds[0], 5, lds[1], 3, 10) == LDS_SUCCESS);
+            va.insert(va.begin() + 5, vb.begin() + 3, vb.begin() + 13);
+            vb.erase(vb.begin() + 3, vb.begin() + 13);
+            VERIFICAR(mesmo_conteudo(lds[0], va) && mesmo_conteudo(lds[1], vb));
+            VERIFICAR(lds_splice(lds[0], 0, lds[0], 1, 1) == LDS_FAIL);
+            VERIFICAR(lds_splice(lds[0], 0, lds[1], 5, 10) == LDS_POS_ERR);
+
+            VERIFICAR(lds_concat(lds[1], lds[0]) == LDS_SUCCESS);
+            vb.insert(vb.end(), va.begin(), va.end());
+            va.clear();
+            VERIFICAR(mesmo_conteudo(lds[0], va) && mesmo_conteudo(lds[1], vb));
+
+            lds[2] = lds_split(lds[1], 7);
+            VERIFICAR(lds[2] != NULL && lds_type(lds[2]) == lds_type(lds[1]));
+            VERIFICAR(mesmo_conteudo(lds[2], vector<int>(vb.begin() + 7, vb.end())));
+            vb.resize(7);
+            VERIFICAR(mesmo_conteudo(lds[1], vb));
+            lds_free(lds[0]);
+            lds_free(lds[1]);
+            lds_free(lds[2]);
+        }
+    }
+
+    // A metade separada de um vetor grande tambm  mapeada, desde a criao.
+    Contabilidade c;
+    c.erros = 0;
+    LDS_ALLOCATOR allocator = { conta_alloc, conta_realloc, conta_free, &c };
+    LINEAR_DS *big = lds_new_vector_ex(4, sizeof(int), &allocator);
+    VERIFICAR(lds_set_mmap_threshold(big, 16384, 1) == LDS_SUCCESS);
+    vector<int> vec;
+    for (int i = 0; i < 20000; i++) {
+        lds_enqueue(big, &i);
+        vec.push_back(i);
+    }
+    LINEAR_DS *tail = lds_split(big, 1000);
+    VERIFICAR(tail != NULL && c.blocos.size() == 2);
+    for (int i = 0; i < 20000; i++) {
+        lds_enqueue(tail, &i);
+        vec.push_back(i);
+    }
+    VERIFICAR(mesmo_conteudo(tail, vector<int>(vec.begin() + 1000, vec.end())));
+    lds_free(tail);
+    lds_free(big);
+    VERIFICAR(c.blocos.empty() && c.erros == 0);
+}
+
+void check_iterator_edits() {
+    LINEAR_DS *lds[3];
+    lds[0] = lds_new_vector(2, sizeof(int));
+    lds[1] = lds_new_list(sizeof(int));
+    lds[2] = lds_new_dlist(sizeof(int));
+    for (int k = 0; k < 3; k++) {
+        LDS_ITERATOR *it = lds_iterator(lds[k]);
+        int value;
+
+        // Consumidor de fila: aps o ltimo, v os elementos que chegam depois.
+        for (int i = 0; i < 3; i++) {
+            lds_enqueue(lds[k], &i);
+        }
+        VERIFICAR(lds_it_go(it, 3) == LDS_SUCCESS);
+        int next = 3;
+        lds_enqueue(lds[k], &next);
+        VERIFICAR(lds_it_position(it) == 3 && lds_it_get(it, &value) == LDS_SUCCESS && value == 3);
+
+        // Inserir pelo iterador o deixa no elemento novo; remover, no seguinte.
+        int added = 10;
+        VERIFICAR(lds_it_go(it, 1) == LDS_SUCCESS);
+        VERIFICAR(lds_it_add(it, &added) == LDS_SUCCESS);
+        VERIFICAR(lds_it_position(it) == 1 && lds_it_get(it, &value) == LDS_SUCCESS && value == 10);
+        VERIFICAR(lds_it_remove(it, &value) == LDS_SUCCESS && value == 10);
+        VERIFICAR(lds_it_position(it) == 1 && lds_it_get(it, &value) == LDS_SUCCESS && value == 1);
+
+        // Alteraes em outras posies no mudam o elemento do iterador.
+        lds_stack_push(lds[k], &added);
+        VERIFICAR(lds_it_position(it) == 2 && lds_it_get(it, &value) == LDS_SUCCESS && value == 1);
+        lds_remove(lds[k], 2, NULL);
+        VERIFICAR(lds_it_position(it) == 2 && lds_it_get(it, &value) == LDS_SUCCESS && value == 2);
+        VERIFICAR(mesmo_conteudo(lds[k], vector<int>({ 10, 0, 2, 3 })));
+        lds_free(lds[k]);
+    }
+
+    // Um cursor de vetor que ficou alm do fim no l, grava nem remove nada.
+    LINEAR_DS *vec_lds = lds_new_vector(8, sizeof(int));
+    for (int i = 0; i < 6; i++) {
+        lds_enqueue(vec_lds, &i);
+    }
+    LDS_CURSOR cursor;
+    LDS_ITERATOR *stale = lds_cursor_init(&cursor, vec_lds);
+    VERIFICAR(lds_it_go(stale, 5) == LDS_SUCCESS);
+    for (int i = 0; i < 3; i++) {
+        lds_dequeue(vec_lds, NULL);
+    }
+    int value = -1;
+    VERIFICAR(lds_it_has_next(stale) == LDS_FAIL);
+    VERIFICAR(lds_it_get(stale, &value) == LDS_POS_ERR);
+    VERIFICAR(lds_it_set(stale, &value) == LDS_POS_ERR);
+    VERIFICAR(lds_it_remove(stale, NULL) == LDS_POS_ERR);
+    VERIFICAR(lds_it_add(stale, &value) == LDS_POS_ERR);
+    VERIFICAR(lds_it_next(stale) == LDS_POS_ERR);
+    VERIFICAR(lds_it_ref(stale) == NULL);
+    VERIFICAR(mesmo_conteudo(vec_lds, vector<int>({ 3, 4, 5 })));
+    VERIFICAR(lds_it_go(stale, 2) == LDS_SUCCESS && lds_it_get(stale, &value) == LDS_SUCCESS && value == 5);
+    lds_free(vec_lds);
+}
+
+/* Percorre a estrutura por trechos e confere cada elemento; devolve o nmero de trechos. */
+static size_t conferir_trechos(LINEAR_DS *lds, const vector<int> & vec, size_t stride, bool & same) {
+    LDS_CURSOR cursor;
+    LDS_ITERATOR *it = lds_cursor_init(&cursor, lds);
+    void *data;
+    size_t n, runs = 0, position = 0;
+    same = true;
+    while ((n = lds_it_next_span(it, &data)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            same = same && position < vec.size() && *(int*)((char*)data + i * stride) == vec[position];
+            position++;
+        }
+        runs++;
+    }
+    same = same && position == vec.size() && data == NULL;
+    return runs;
+}
+
+void check_spans() {
+    bool same;
+    LINEAR_DS *lds = lds_new_vector(8, sizeof(int));
+    vector<int> vec;
+    VERIFICAR(conferir_trechos(lds, vec, sizeof(int), same) == 0 && same);
+
+    // Vetor que d a volta no buffer: dois trechos.
+    for (int i = 0; i < 6; i++) {
+        lds_enqueue(lds, &i);
+        vec.push_back(i);
+    }
+    for (int i = 0; i < 4; i++) {
+        lds_dequeue(lds, NULL);
+        vec.erase(vec.begin());
+        int j = 6 + i;
+        lds_enqueue(lds, &j);
+        vec.push_back(j);
+    }
+    VERIFICAR(conferir_trechos(lds, vec, sizeof(int), same) == 2 && same);
+
+    // Durante uma migrao, os trechos seguem os dois vetores.
+    lds_set_incremental_growth(lds);
+    for (int i = 0; i < 5; i++) {
+        int j = 10 + i;
+        lds_enqueue(lds, &j);
+        vec.push_back(j);
+    }
+    conferir_trechos(lds, vec, sizeof(int), same);
+    VERIFICAR(same);
+    lds_free(lds);
+
+    // Lista: um trecho por n.
+    lds = lds_new_list(sizeof(int));
+    for (size_t i = 0; i < vec.size(); i++) {
+        lds_enqueue(lds, &vec[i]);
+    }
+    VERIFICAR(conferir_trechos(lds, vec, sizeof(int), same) == vec.size() && same);
+    lds_free(lds);
+
+    // Vetor com preenchimento: os elementos ficam a stride bytes uns dos outros.
+    lds = lds_new_vector_aligned(4, sizeof(int), 64, 1);
+    for (size_t i = 0; i < vec.size(); i++) {
+        lds_enqueue(lds, &vec[i]);
+    }
+    VERIFICAR(conferir_trechos(lds, vec, 64, same) == 1 && same);
+    void *data;
+    VERIFICAR(lds_it_next_span(NULL, &data) == 0);
+    VERIFICAR(lds_it_next_span(lds_iterator(lds), NULL) == 0);
+    lds_free(lds);
+}
+
+void check_views() {
+    LINEAR_DS *lds[4];
+    lds[0] = lds_new_vector(4, sizeof(int));
+    lds[1] = lds_new_list(sizeof(int));
+    lds[2] = lds_new_dlist(sizeof(int));
+    lds[3] = lds_new_rt_vector(64, sizeof(int), 0);
+    for (int k = 0; k < 4; k++) {
+        vector<int> vec;
+        for (int i = 0; i < 40; i++) {
+            lds_enqueue(lds[k], &i);
+            vec.push_back(i);
+        }
+        LINEAR_DS *view = lds_view(lds[k], 10, 20);
+        vector<int> part(vec.begin() + 10, vec.begin() + 30);
+        VERIFICAR(view != NULL && mesmo_conteudo(view, part));
+        VERIFICAR(lds_type(view) == lds_type(lds[k]));
+
+        // O iterador da viso comea no seu primeiro elemento.
+        int value;
+        VERIFICAR(lds_it_get(lds_iterator(view), &value) == LDS_SUCCESS && value == 10);
+        VERIFICAR(mesmo_conteudo_ao_contrario(view, part));
+
+        // A viso s l, e no conta como estrutura de tempo real.
+        VERIFICAR(lds_insert(view, 0, &value) == LDS_FAIL);
+        VERIFICAR(lds_remove(view, 0, NULL) == LDS_FAIL);
+        VERIFICAR(lds_allocation_free(view) == LDS_FAIL);
+
+        // Viso de viso, e cpia independente.
+        LINEAR_DS *inner = lds_view(view, 5, 5);
+        VERIFICAR(mesmo_conteudo(inner, vector<int>(part.begin() + 5, part.begin() + 10)));
+        LINEAR_DS *copy = lds_view_materialize(view);
+        VERIFICAR(copy != NULL && mesmo_conteudo(copy, part));
+        VERIFICAR(lds_enqueue(copy, &value) == LDS_SUCCESS);
+        lds_free(inner);
+        lds_free(view);
+        VERIFICAR(lds_view(lds[k], 30, 11) == NULL);
+        lds_free(lds[k]);
+        lds_free(copy);
+    }
+
+    // A cpia de uma viso de um vetor grande  mapeada desde a criao.
+    Contabilidade c;
+    c.erros = 0;
+    LDS_ALLOCATOR allocator = { conta_alloc, conta_realloc, conta_free, &c };
+    LINEAR_DS *big = lds_new_vector_ex(4, sizeof(int), &allocator);
+    VERIFICAR(lds_set_mmap_threshold(big, 16384, 0) == LDS_SUCCESS);
+    vector<int> vec;
+    for (int i = 0; i < 20000; i++) {
+        lds_enqueue(big, &i);
+        vec.push_back(i);
+    }
+    LINEAR_DS *view = lds_view(big, 100, 10000);
+    LINEAR_DS *copy = lds_view_materialize(view);
+    lds_free(view);
+    lds_free(big);
+    VERIFICAR(copy != NULL && c.blocos.size() == 1);
+    vec = vector<int>(vec.begin() + 100, vec.begin() + 10100);
+    for (int i = 0; i < 20000; i++) {
+        lds_stack_push(copy, &i);
+        vec.insert(vec.begin(), i);
+    }
+    VERIFICAR(mesmo_conteudo(copy, vec));
+    lds_free(copy);
+    VERIFICAR(c.blocos.empty() && c.erros == 0);
+}
+
+/* Memria travada do processo, em kB (VmLck), ou 0 se no houver como saber. */
+static size_t memoria_travada() {
+    FILE *status = fopen("/proc/self/status", "r");
+    size_t kb = 0;
+    char line[256];
+    while (status != NULL && fgets(line, sizeof(line), status) != NULL) {
+        if (sscanf(line, "VmLck: %zu", &kb) == 1) {
+            break;
+        }
+    }
+    if (status != NULL) {
+        fclose(status);
+    }
+    return kb;
+}
+
+void check_locked_views() {
+    // Sem permisso para travar memria, no h o que verificar.
+    LINEAR_DS *rt[2];
+    rt[0] = lds_new_rt_vector(1024, sizeof(int), 1);
+    rt[1] = lds_new_rt_list(sizeof(int), 1024, 1);
+    for (int k = 0; k < 2; k++) {
+        if (rt[k] == NULL) {
+            continue;
+        }
+        vector<int> vec;
+        for (int i = 0; i < 100; i++) {
+            lds_enqueue(rt[k], &i);
+            vec.push_back(i);
+        }
+
+        // Vises e cpias no ocupam pginas travadas.
+        size_t locked = memoria_travada();
+        LINEAR_DS *views[20], *copies[20];
+        for (int i = 0; i < 20; i++) {
+            views[i] = lds_view(rt[k], (size_t)i, 50);
+            copies[i] = lds_view_materialize(views[i]);
+        }
+        VERIFICAR(memoria_travada() == locked);
+        VERIFICAR(mesmo_conteudo(views[7], vector<int>(vec.begin() + 7, vec.begin() + 57)));
+        VERIFICAR(mesmo_conteudo(copies[7], vector<int>(vec.begin() + 7, vec.begin() + 57)));
+        VERIFICAR(lds_enqueue(copies[7], &k) == LDS_SUCCESS && lds_allocation_free(copies[7]) == LDS_FAIL);
+        for (int i = 0; i < 20; i++) {
+            lds_free(copies[i]);
+            lds_free(views[i]);
+        }
+        VERIFICAR(memoria_travada() == locked);
+        lds_free(rt[k]);
+    }
+}
+
+int main() {
+    check_node_pool();
+    check_allocator();
+    check_arena();
+    check_list_queue();
+    check_dlist();
+    check_pow2();
+    check_ring_shift();
+    check_capacity();
+    check_small_vector();
+    check_ops_tables();
+    check_caller_owned();
+    check_incremental();
+    check_mmap();
+    check_rt();
+    check_element_sizes();
+    check_aligned();
+    check_node_alignment();
+    check_emplace();
+    check_ranges();
+    check_iterator_follows();
+    check_splice();
+    check_iterator_edits();
+    check_spans();
+    check_views();
+    check_locked_views();
+
+    if (falhas > 0) {
+        cout << falhas << " verificacoes falharam." << endl;
+        return 1;
+    }
+    cout << "Todas as verificacoes passaram." << endl;
+    return 0;
+}
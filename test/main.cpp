@@ -26,7 +26,8 @@ int main() {
 
     cout << "Que tipo de estrutura de dados deseja testar ("
          << LDS_VECTOR << "-LDS_VECTOR, "
-         << LDS_LINKED_LIST << "-LDS_LINKED_LIST)? ";
+         << LDS_LINKED_LIST << "-LDS_LINKED_LIST, "
+         << LDS_DOUBLY_LINKED_LIST << "-LDS_DOUBLY_LINKED_LIST)? ";
     cin >> type;
 
     LINEAR_DS *lds;
@@ -37,6 +38,9 @@ int main() {
         case LDS_LINKED_LIST:
         lds = lds_new_list(sizeof(int)); // cria uma estrutura de dados da biblioteca
         break;
+        case LDS_DOUBLY_LINKED_LIST:
+        lds = lds_new_dlist(sizeof(int)); // cria uma estrutura de dados da biblioteca
+        break;
         default:
         cout << "Tipo invalido!" << endl;
         return 1;
@@ -67,7 +71,7 @@ int main() {
     lds_free(lds);
 
     fprintf(log, "\n\nOperacoes: %d\n", num_operations);
-    fprintf(log, "Tipo de estrutura: %s\n", (type == LDS_VECTOR ? "LDS_VECTOR" : "LDS_LINKED_LIST"));
+    fprintf(log, "Tipo de estrutura: %s\n", (type == LDS_VECTOR ? "LDS_VECTOR" : type == LDS_LINKED_LIST ? "LDS_LINKED_LIST" : "LDS_DOUBLY_LINKED_LIST"));
     fprintf(log, "Interface: %s\n", (interf == 1 ? "LINEAR_DS" : "LDS_ITERATOR"));
 
     fclose(log);